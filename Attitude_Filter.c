@@ -0,0 +1,172 @@
+/*
+ * Attitude_Filter.c
+ *
+ *  Optional complementary (Mahony style PI) filter which fuses the
+ *  RPY samples received from the IMU into a smoothed attitude
+ *  estimate that can be read at any rate, between samples too.
+ *
+ *  Per axis, every received sample gives an angle error (wrapped
+ *  with atan2(sin,cos) so ±180 deg is handled). The proportional
+ *  term pulls the angle in, the integral term learns the angular
+ *  rate used to propagate the estimate between samples.
+ *  The trig goes through the CMATH_ macros: TMU instructions with
+ *  --tmu_support=tmu0, libm otherwise.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#define DEG2RAD (3.14159265f/180.0f)
+#define RAD2DEG (180.0f/3.14159265f)
+
+ATT_FILTER_TYPE    g_AttFilter;
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+ATT_FILTER_BENCH_TYPE g_AttFilterBench;
+#endif
+
+
+
+/*
+** f_WrapPi
+** Fold an angle (rad) into [-pi,pi] */
+static float f_WrapPi( float Angle )
+{
+    return( CMATH_ATAN2( CMATH_SIN( Angle ), CMATH_COS( Angle ) ) );
+} /* End f_WrapPi */
+
+
+
+/*
+** f_AttFilter_Init
+** Kp (1/s) sets how hard each sample pulls the estimate,
+** Ki (1/s^2) how quickly the rate estimate follows */
+void f_AttFilter_Init( ATT_FILTER_TYPE *F, float Kp, float Ki )
+{
+    memset( F, 0, sizeof(ATT_FILTER_TYPE) );
+    F->Kp = Kp;
+    F->Ki = Ki;
+} /* End f_AttFilter_Init */
+
+
+
+/*
+** f_AttFilter_Propagate
+** Move the estimate forward to Stamp (IPC counter ticks)
+** using the learned rates */
+void f_AttFilter_Propagate( ATT_FILTER_TYPE *F, Uint64 Stamp )
+{
+    int i;
+    float dt;
+
+    if( (F->Valid == FALSE) || (Stamp <= F->Stamp) ) { return; }
+
+    dt = (float)(Stamp - F->Stamp) * (1.0f/(IPC_TICKS_PER_US*1.0e6f));
+    F->Stamp = Stamp;
+
+    for( i=0; i<3; i++ )
+    {
+        F->Angle[i] = f_WrapPi( F->Angle[i] + F->Rate[i]*dt );
+    }
+} /* End f_AttFilter_Propagate */
+
+
+
+/*
+** f_AttFilter_Correct
+** Fuse one received sample, taken at Stamp */
+void f_AttFilter_Correct( ATT_FILTER_TYPE *F, DATA_TYPE *Meas, Uint64 Stamp )
+{
+    int i;
+    float Meas_r[3], Err, dt;
+
+    Meas_r[0] = Meas->Roll  * DEG2RAD;
+    Meas_r[1] = Meas->Pitch * DEG2RAD;
+    Meas_r[2] = Meas->Yaw   * DEG2RAD;
+
+    /* First sample: just take it */
+    if( F->Valid == FALSE )
+    {
+        for( i=0; i<3; i++ ) { F->Angle[i] = Meas_r[i]; F->Rate[i] = 0; }
+        F->Stamp     = Stamp;
+        F->LastMeas  = Stamp;
+        F->Valid     = TRUE;
+        F->Corrections++;
+        return;
+    }
+
+    f_AttFilter_Propagate( F, Stamp );
+
+    dt = (float)(Stamp - F->LastMeas) * (1.0f/(IPC_TICKS_PER_US*1.0e6f));
+    F->LastMeas = Stamp;
+
+    /* Don't let one long gap kick the estimate around */
+    if( dt > ATT_FILTER_MAX_DT ) { dt = ATT_FILTER_MAX_DT; }
+
+    for( i=0; i<3; i++ )
+    {
+        Err = f_WrapPi( Meas_r[i] - F->Angle[i] );
+
+        F->Rate[i]  += F->Ki * Err * dt;
+        F->Angle[i]  = f_WrapPi( F->Angle[i] + F->Kp * Err * dt );
+    }
+
+    F->Corrections++;
+} /* End f_AttFilter_Correct */
+
+
+
+/*
+** f_AttFilter_Estimate
+** Attitude estimate (deg) at Stamp, which may be later than
+** the last sample. The filter itself is left untouched */
+void f_AttFilter_Estimate( ATT_FILTER_TYPE *F, Uint64 Stamp, DATA_TYPE *Out )
+{
+    ATT_FILTER_TYPE Copy = *F;
+
+    f_AttFilter_Propagate( &Copy, Stamp );
+
+    Out->Roll  = Copy.Angle[0] * RAD2DEG;
+    Out->Pitch = Copy.Angle[1] * RAD2DEG;
+    Out->Yaw   = Copy.Angle[2] * RAD2DEG;
+} /* End f_AttFilter_Estimate */
+
+
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+/*
+** f_AttFilter_Benchmark
+** Time nUpdates correct/estimate cycles on a synthetic rotating
+** sample. The IPC counter runs at SYSCLK, so ticks are cycles.
+** Build once with and once without --tmu_support to compare
+** g_AttFilterBench.CyclesPerUpdate. tools/att_filter_bench.py
+** runs it on the host, libm side */
+void f_AttFilter_Benchmark( Uint16 nUpdates )
+{
+    Uint16 i;
+    ATT_FILTER_TYPE F;
+    DATA_TYPE Meas, Out;
+    Uint64 Stamp, Start, Cycles;
+
+    f_AttFilter_Init( &F, ATT_FILTER_KP, ATT_FILTER_KI );
+    memset( &Meas, 0, sizeof(DATA_TYPE) );
+    Stamp  = 0;
+    Cycles = 0;
+
+    for( i=0; i<nUpdates; i++ )
+    {
+        Meas.Roll  = 10.0f;
+        Meas.Pitch = -5.0f;
+        Meas.Yaw   = (float)((i*7) % 360) - 180.0f;
+        Stamp     += 20000UL*IPC_TICKS_PER_US;  /* 50 Hz */
+
+        Start = ReadIpcTimer();
+        f_AttFilter_Correct( &F, &Meas, Stamp );
+        f_AttFilter_Estimate( &F, Stamp + 5000UL*IPC_TICKS_PER_US, &Out );
+        Cycles += ReadIpcTimer() - Start;
+    }
+
+    g_AttFilterBench.Updates         = nUpdates;
+    g_AttFilterBench.CyclesPerUpdate = (nUpdates > 0) ? (Uint32)(Cycles / nUpdates) : 0;
+    g_AttFilterBench.Tmu             = CMATH_TMU;
+} /* End f_AttFilter_Benchmark */
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Attitude_Math.c
+ *
+ *  Quaternion <-> Euler conversions.
+ *  Euler angles are aerospace ZYX (yaw, then pitch, then roll)
+ *  in degrees, quaternions are {w, x, y, z} with w >= 0.
+ *  All trig goes through the CMATH_ macros (TMU when available).
+ */
+
+#include "COMEX_Proj.h"
+
+
+#define DEG2RAD (3.14159265f/180.0f)
+#define RAD2DEG (180.0f/3.14159265f)
+
+/* Called per sample (f_DecodePacket, f_AttPost_Run), so in LS
+** RAM with it. With the TMU the trig is inline, otherwise it is
+** the rts library's and runs from .text */
+#pragma CODE_SECTION(f_EulerToQuat, "ComexHotCode");
+#if COMEX_PKT_QUAT_Q14 || COMEX_PKT_QUAT_F32
+#pragma CODE_SECTION(f_QuatNormalize, "ComexHotCode");
+#pragma CODE_SECTION(f_QuatToEuler, "ComexHotCode");
+#endif
+
+
+
+/*
+** f_QuatNormalize
+** Scale a quaternion to unit length and put it in the w >= 0
+** hemisphere. Quantized (Q14) quaternions need this */
+void f_QuatNormalize( float *Quat )
+{
+    int i;
+    float Norm, Scale;
+
+    Norm = CMATH_SQRT( Quat[0]*Quat[0] + Quat[1]*Quat[1] + Quat[2]*Quat[2] + Quat[3]*Quat[3] );
+    if( Norm < 1.0e-6f )
+    {
+        Quat[0] = 1.0f; Quat[1] = 0; Quat[2] = 0; Quat[3] = 0;
+        return;
+    }
+
+    Scale = (Quat[0] < 0) ? -1.0f/Norm : 1.0f/Norm;
+    for( i=0; i<4; i++ ) { Quat[i] *= Scale; }
+} /* End f_QuatNormalize */
+
+
+
+/*
+** f_EulerToQuat
+** Roll/pitch/yaw (deg) to a unit quaternion */
+void f_EulerToQuat( float Roll, float Pitch, float Yaw, float *Quat )
+{
+    float cr, sr, cp, sp, cy, sy;
+
+    cr = CMATH_COS( Roll  * (0.5f*DEG2RAD) );  sr = CMATH_SIN( Roll  * (0.5f*DEG2RAD) );
+    cp = CMATH_COS( Pitch * (0.5f*DEG2RAD) );  sp = CMATH_SIN( Pitch * (0.5f*DEG2RAD) );
+    cy = CMATH_COS( Yaw   * (0.5f*DEG2RAD) );  sy = CMATH_SIN( Yaw   * (0.5f*DEG2RAD) );
+
+    Quat[0] = cr*cp*cy + sr*sp*sy;
+    Quat[1] = sr*cp*cy - cr*sp*sy;
+    Quat[2] = cr*sp*cy + sr*cp*sy;
+    Quat[3] = cr*cp*sy - sr*sp*cy;
+
+    if( Quat[0] < 0 )
+    {
+        Quat[0] = -Quat[0]; Quat[1] = -Quat[1]; Quat[2] = -Quat[2]; Quat[3] = -Quat[3];
+    }
+} /* End f_EulerToQuat */
+
+
+
+/*
+** f_QuatToEuler
+** Unit quaternion to roll/pitch/yaw (deg).
+** asin is done as atan2(s, sqrt(1-s^2)) so it stays on the TMU,
+** and s is clamped so rounding near ±90 deg pitch can't NaN */
+void f_QuatToEuler( float *Quat, float *Roll, float *Pitch, float *Yaw )
+{
+    float w = Quat[0], x = Quat[1], y = Quat[2], z = Quat[3];
+    float s;
+
+    *Roll = CMATH_ATAN2( 2.0f*(w*x + y*z), 1.0f - 2.0f*(x*x + y*y) ) * RAD2DEG;
+
+    s = 2.0f*(w*y - z*x);
+    if( s >  1.0f ) { s =  1.0f; }
+    if( s < -1.0f ) { s = -1.0f; }
+    *Pitch = CMATH_ATAN2( s, CMATH_SQRT( 1.0f - s*s ) ) * RAD2DEG;
+
+    *Yaw = CMATH_ATAN2( 2.0f*(w*z + x*y), 1.0f - 2.0f*(y*y + z*z) ) * RAD2DEG;
+} /* End f_QuatToEuler */
@@ -0,0 +1,335 @@
+/*
+ * Attitude_Post.c
+ *
+ *  Attitude post-processing of the RPY packets: scaling, the IMU
+ *  mounting rotation, angle unwrap and a low pass, per link.
+ *  With COMEX_USE_CLA_POST the math runs in Cla1Task1 and this is
+ *  the CLA setup and the hand off of each packet to the task;
+ *  without it f_AttPost_Reference, the C28x copy of the task,
+ *  runs in its place and gives the same result.
+ *
+ *  The result is the attitude of the RPY packets: f_AttPost_Run
+ *  puts it in the sample before the link, snapshot, filter and
+ *  control code see it, and f_DecodePacket leaves their angles
+ *  to it.
+ */
+
+#include "COMEX_Proj.h"
+
+
+/* CPU <-> CLA message RAM */
+#pragma DATA_SECTION(g_ClaAttIn, "CpuToCla1MsgRAM");
+CLA_ATT_IN_TYPE g_ClaAttIn;
+
+#pragma DATA_SECTION(g_ClaAttOut, "Cla1ToCpuMsgRAM");
+CLA_ATT_OUT_TYPE g_ClaAttOut;
+
+#pragma DATA_SECTION(g_AttPostStats, "ComexTrace");
+ATT_POST_STATS_TYPE g_AttPostStats;
+
+#if COMEX_USE_CLA_POST
+/* The task's input is built in message RAM */
+#define ATT_POST_IN (&g_ClaAttIn)
+
+/* Set by the CLA end of task interrupt */
+static volatile Uint16 s_ClaDone;
+
+#if COMEX_CLA_CHECK
+/* Last input to the CLA, for the reference */
+static CLA_ATT_IN_TYPE s_RefIn;
+#endif
+
+__interrupt void f_Cla1Task1Isr( void );
+
+#pragma CODE_SECTION(f_AttPost_Start, "ComexHotCode");
+#pragma CODE_SECTION(f_AttPost_Result, "ComexHotCode");
+#pragma CODE_SECTION(f_Cla1Task1Isr, "ComexHotCode");
+#else
+/* No CLA, the C28x runs the task's math on its own copy */
+static CLA_ATT_IN_TYPE s_AttPostIn;
+#define ATT_POST_IN (&s_AttPostIn)
+
+#pragma CODE_SECTION(f_AttPost_Reference, "ComexHotCode");
+#endif
+
+#pragma CODE_SECTION(f_AttPost_Run, "ComexHotCode");
+#pragma CODE_SECTION(f_AttPostLoad, "ComexHotCode");
+
+
+
+/*
+** f_AttPost_Init
+** Point task 1 at Cla1Task1 and hook the end of task interrupt
+** (COMEX_USE_CLA_POST), and set the task's parameters.
+** MountYaw is the IMU mounting yaw in degrees, Alpha the
+** low pass coefficient (1 = no filtering) */
+void f_AttPost_Init( float MountYaw, float Alpha )
+{
+    float Rad = MountYaw * (3.14159265f/180.0f);
+
+#if COMEX_USE_CLA_POST
+    EALLOW;
+
+    /* Clear the CLA message RAMs */
+    MemCfgRegs.MSGxINIT.bit.INIT_CLA1TOCPU = 1;
+    while( MemCfgRegs.MSGxINITDONE.bit.INITDONE_CLA1TOCPU != 1 ) {}
+    MemCfgRegs.MSGxINIT.bit.INIT_CPUTOCLA1 = 1;
+    while( MemCfgRegs.MSGxINITDONE.bit.INITDONE_CPUTOCLA1 != 1 ) {}
+
+    /* The LS blocks were handed to the CLA by f_MemCfg_Init */
+
+    /* Task 1 is software forced only */
+    Cla1Regs.MVECT1 = (Uint16)((Uint32)&Cla1Task1);
+    DmaClaSrcSelRegs.CLA1TASKSRCSEL1.bit.TASK1 = 0;
+    Cla1Regs.MCTL.bit.IACKE = 1;
+    Cla1Regs.MIER.all       = 0x0001;
+
+    PieVectTable.CLA1_1_INT = &f_Cla1Task1Isr;
+    EDIS;
+
+    PieCtrlRegs.PIEIER11.bit.INTx1 = 1;
+    IER |= M_INT11;
+
+    s_ClaDone = 0;
+#else
+    memset( &s_AttPostIn, 0, sizeof(CLA_ATT_IN_TYPE) );
+#endif
+
+    ATT_POST_IN->Alpha     = Alpha;
+    ATT_POST_IN->MountCos  = cosf( Rad );
+    ATT_POST_IN->MountSin  = sinf( Rad );
+    ATT_POST_IN->YawOffset = MountYaw;
+
+    memset( &g_AttPostStats, 0, sizeof(ATT_POST_STATS_TYPE) );
+} /* End f_AttPost_Init */
+
+
+
+/*
+** f_AttPostLoad
+** Put a checked RPY packet's angles (type 1, 2, 5 or 6) and the
+** link's state in the task's input. Only the byte assembly is
+** done here, everything else is the task's.
+** Returns FALSE for other packet types */
+static bool f_AttPostLoad( RESPONSE_TYPE *Response, CLA_ATT_STATE_TYPE *State )
+{
+    int i;
+    unsigned int Word;
+
+    if( (Response->PacketType != 1) && (Response->PacketType != 2) &&
+        (Response->PacketType != 5) && (Response->PacketType != 6) ) { return( FALSE ); }
+
+    ATT_POST_IN->PacketType = Response->PacketType;
+    for( i=0; i<3; i++ )
+    {
+        if( Response->PacketType == 1 )
+        {
+            f_UnpackInt_u16( &Response->Buffer[SFLOAT*i], &Word );
+            ATT_POST_IN->RawQ7[i] = (int16_t)Word;
+        }
+        else
+        {
+            f_UnpackFloat_s32( &Response->Buffer[SFLOAT*2*i], &ATT_POST_IN->RawF32[i] );
+        }
+    }
+    ATT_POST_IN->State = *State;
+
+    return( TRUE );
+} /* End f_AttPostLoad */
+
+
+
+#if COMEX_USE_CLA_POST
+#if COMEX_CLA_CHECK
+/*
+** f_AngleErr
+** |A - B| the short way round (deg), so results either side of
+** the fold at +-180 aren't a mismatch */
+static float f_AngleErr( float A, float B )
+{
+    float Err = fabsf( A - B );
+
+    return( (Err > 180.0f) ? 360.0f - Err : Err );
+} /* End f_AngleErr */
+#endif
+
+
+
+/*
+** f_AttPost_Start
+** Hand a checked RPY packet and its link's state to the CLA.
+** Returns FALSE for other packet types, or if the previous
+** task has not finished */
+bool f_AttPost_Start( RESPONSE_TYPE *Response, CLA_ATT_STATE_TYPE *State )
+{
+    if( Cla1Regs.MIRUN.bit.INT1 == 1 )
+    {
+        g_AttPostStats.Busy++;
+        return( FALSE );
+    }
+    if( f_AttPostLoad( Response, State ) == FALSE ) { return( FALSE ); }
+
+#if COMEX_CLA_CHECK
+    s_RefIn = g_ClaAttIn;
+#endif
+
+    s_ClaDone = 0;
+    Cla1ForceTask1();
+    g_AttPostStats.Started++;
+
+    return( TRUE );
+} /* End f_AttPost_Start */
+
+
+
+/*
+** f_AttPost_Result
+** Copy out the CLA result once task 1 has completed.
+** With COMEX_CLA_CHECK set the same sample is also run
+** through f_AttPost_Reference and compared.
+** Returns TRUE if a new result was copied into Out */
+bool f_AttPost_Result( CLA_ATT_OUT_TYPE *Out )
+{
+#if COMEX_CLA_CHECK
+    CLA_ATT_OUT_TYPE Ref;
+#endif
+
+    if( s_ClaDone == 0 ) { return( FALSE ); }
+    s_ClaDone = 0;
+
+    *Out = g_ClaAttOut;
+    g_AttPostStats.Completed++;
+
+#if COMEX_CLA_CHECK
+    f_AttPost_Reference( &s_RefIn, &Ref );
+    if( (f_AngleErr( Ref.Roll, Out->Roll ) > CLA_CHECK_TOL) ||
+        (fabsf( Ref.Pitch - Out->Pitch ) > CLA_CHECK_TOL) ||
+        (f_AngleErr( Ref.Yaw, Out->Yaw ) > CLA_CHECK_TOL) )
+    {
+        g_AttPostStats.Mismatch++;
+    }
+#endif
+
+    return( TRUE );
+} /* End f_AttPost_Result */
+#endif /* COMEX_USE_CLA_POST */
+
+
+
+/*
+** f_AttPost_Run
+** Run a checked packet's angles through the post-processing
+** with the link's State, and put the result in Data: roll,
+** pitch, yaw and their quaternion. On the CLA it waits up to
+** ATT_POST_WAIT_US for the task.
+** Returns FALSE for an RPY packet with no result (Data has
+** no angles then, State is as it was), TRUE otherwise */
+bool f_AttPost_Run( CLA_ATT_STATE_TYPE *State, RESPONSE_TYPE *Response, DATA_TYPE *Data )
+{
+    CLA_ATT_OUT_TYPE Post;
+#if COMEX_USE_CLA_POST
+    DEADLINE_TYPE Deadline;
+#endif
+
+    if( (Response->PacketType != 1) && (Response->PacketType != 2) &&
+        (Response->PacketType != 5) && (Response->PacketType != 6) ) { return( TRUE ); }
+
+#if COMEX_USE_CLA_POST
+    if( f_AttPost_Start( Response, State ) == FALSE ) { return( FALSE ); }
+
+    Deadline = f_Deadline_Set( ATT_POST_WAIT_US );
+    while( f_AttPost_Result( &Post ) == FALSE )
+    {
+        if( f_Deadline_Expired( Deadline ) )
+        {
+            g_AttPostStats.Late++;
+            return( FALSE );
+        }
+    }
+#else
+    f_AttPostLoad( Response, State );
+    f_AttPost_Reference( &s_AttPostIn, &Post );
+#endif
+
+    *State = Post.State;
+    Data->Roll  = Post.Roll;
+    Data->Pitch = Post.Pitch;
+    Data->Yaw   = Post.Yaw;
+    f_EulerToQuat( Data->Roll, Data->Pitch, Data->Yaw, &Data->Quat[0] );
+
+    return( TRUE );
+} /* End f_AttPost_Run */
+
+
+
+/*
+** f_AttPost_Reference
+** C28x copy of Cla1Task1, step for step.
+** Runs the post-processing when the CLA is not in use
+** (COMEX_USE_CLA_POST 0), and checks the CLA (COMEX_CLA_CHECK) */
+void f_AttPost_Reference( CLA_ATT_IN_TYPE *In, CLA_ATT_OUT_TYPE *Out )
+{
+    CLA_ATT_STATE_TYPE *S = &Out->State;
+    float Roll, Pitch, Yaw, Tilt, Delta;
+
+    if( In->PacketType == 1 )
+    {
+        Roll  = (float)In->RawQ7[0] * CLA_Q7_SCALE;
+        Pitch = (float)In->RawQ7[1] * CLA_Q7_SCALE;
+        Yaw   = (float)In->RawQ7[2] * CLA_Q7_SCALE;
+    }
+    else
+    {
+        Roll  = In->RawF32[0];
+        Pitch = In->RawF32[1];
+        Yaw   = In->RawF32[2];
+    }
+
+    Tilt  = In->MountCos*Roll + In->MountSin*Pitch;
+    Pitch = In->MountCos*Pitch - In->MountSin*Roll;
+    Roll  = Tilt;
+    Yaw   = Yaw + In->YawOffset;
+
+    *S = In->State;
+    if( S->Count == 0 )
+    {
+        S->Roll  = Roll;
+        S->Pitch = Pitch;
+        S->Yaw   = Yaw;
+    }
+
+    Delta = Roll - S->Roll;
+    if( Delta >  180.0f ) { Delta -= 360.0f; }
+    if( Delta < -180.0f ) { Delta += 360.0f; }
+    S->Roll += In->Alpha*Delta;
+
+    S->Pitch += In->Alpha*(Pitch - S->Pitch);
+
+    Delta = Yaw - S->Yaw;
+    if( Delta >  180.0f ) { Delta -= 360.0f; }
+    if( Delta < -180.0f ) { Delta += 360.0f; }
+    S->Yaw += In->Alpha*Delta;
+    S->Count++;
+
+    if( S->Roll >=  180.0f ) { S->Roll -= 360.0f; }
+    if( S->Roll <  -180.0f ) { S->Roll += 360.0f; }
+    if( S->Yaw  >=  180.0f ) { S->Yaw  -= 360.0f; }
+    if( S->Yaw  <  -180.0f ) { S->Yaw  += 360.0f; }
+
+    Out->Roll  = S->Roll;
+    Out->Pitch = S->Pitch;
+    Out->Yaw   = S->Yaw;
+} /* End f_AttPost_Reference */
+
+
+
+#if COMEX_USE_CLA_POST
+/*
+** f_Cla1Task1Isr
+** CLA task 1 end of task interrupt */
+__interrupt void f_Cla1Task1Isr( void )
+{
+    s_ClaDone = 1;
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP11;
+} /* End f_Cla1Task1Isr */
+#endif
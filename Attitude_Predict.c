@@ -0,0 +1,260 @@
+/*
+ * Attitude_Predict.c
+ *
+ *  Latency compensation. Keeps a short history of timestamped
+ *  samples (arrival stamps from the RX ISR) and extrapolates
+ *  roll/pitch/yaw to any query time, so a fixed rate control
+ *  loop gets a current estimate rather than one a packet old.
+ *
+ *  Angles are stored unwrapped (the short way round from the
+ *  previous sample) so ±180 deg crossings extrapolate smoothly,
+ *  and are folded back into [-180,180) on the way out.
+ *
+ *  f_AttPredict_Check (COMEX_INSTRUMENT INSTR_BENCH) runs a
+ *  predictor of its own on a synthetic, noise free trajectory and
+ *  records the prediction error against the true attitude on
+ *  target. tools/att_predict_sim.py builds this file on the host
+ *  and measures all three modes against a trajectory with packet
+ *  latency, stamp jitter and noise.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#pragma DATA_SECTION(g_AttPredict, "ComexHistory");
+ATT_PREDICT_TYPE g_AttPredict;
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+ATT_PREDICT_CHECK_TYPE g_AttPredictCheck;
+#endif
+
+
+
+/*
+** f_WrapDeg
+** Fold an angle (deg) into [-180,180) */
+static float f_WrapDeg( float Angle )
+{
+    Angle = Angle - 360.0f*(float)(int32_t)(Angle*(1.0f/360.0f));
+    if( Angle >=  180.0f ) { Angle -= 360.0f; }
+    if( Angle <  -180.0f ) { Angle += 360.0f; }
+    return( Angle );
+} /* End f_WrapDeg */
+
+
+
+/*
+** f_AttPredict_Init
+** Mode is one of ATT_PREDICT_HOLD, _LINEAR or _RATE */
+void f_AttPredict_Init( ATT_PREDICT_TYPE *P, Uint16 Mode )
+{
+    memset( P, 0, sizeof(ATT_PREDICT_TYPE) );
+    P->Mode = Mode;
+} /* End f_AttPredict_Init */
+
+
+
+/*
+** f_AttPredict_Slope
+** Angular rates (deg/s) from the history.
+** LINEAR: the last two samples. RATE: least squares fit over
+** the whole history, i.e. the best constant angular rate.
+** Times and angles are taken relative to the newest sample so
+** the sums keep their precision in single float */
+static void f_AttPredict_Slope( ATT_PREDICT_TYPE *P, float *Rate )
+{
+    int i, k, n;
+    Uint16 Newest, Slot;
+    float t, St, Stt, Sa[3], Sta[3], Den;
+
+    Newest = (P->Head - 1) & (ATT_PREDICT_DEPTH-1);
+    n = (P->Mode == ATT_PREDICT_LINEAR) ? 2 : P->Count;
+
+    St = 0; Stt = 0;
+    for( k=0; k<3; k++ ) { Sa[k] = 0; Sta[k] = 0; Rate[k] = 0; }
+
+    for( i=0; i<n; i++ )
+    {
+        Slot = (P->Head - 1 - i) & (ATT_PREDICT_DEPTH-1);
+        t = -(float)(P->Stamp[Newest] - P->Stamp[Slot]) * (1.0f/(IPC_TICKS_PER_US*1.0e6f));
+
+        St  += t;
+        Stt += t*t;
+        for( k=0; k<3; k++ )
+        {
+            Sa[k]  += P->Angle[Slot][k] - P->Angle[Newest][k];
+            Sta[k] += t*(P->Angle[Slot][k] - P->Angle[Newest][k]);
+        }
+    }
+
+    Den = (float)n*Stt - St*St;
+    if( Den < 1.0e-9f ) { return; }   /* Samples share a stamp */
+
+    for( k=0; k<3; k++ )
+    {
+        Rate[k] = ((float)n*Sta[k] - St*Sa[k]) / Den;
+    }
+} /* End f_AttPredict_Slope */
+
+
+
+/*
+** f_AttPredict_Query
+** Attitude (deg) at Stamp (IPC counter). Stamp may be before or
+** after the newest sample, the extrapolation is limited to
+** ATT_PREDICT_MAX_US either way.
+** Returns FALSE (and leaves Out alone) until there is a sample */
+bool f_AttPredict_Query( ATT_PREDICT_TYPE *P, Uint64 Stamp, DATA_TYPE *Out )
+{
+    int k;
+    Uint16 Newest;
+    float dt, Rate[3], Angle[3];
+    float Max = (float)ATT_PREDICT_MAX_US * 1.0e-6f;   /* Negated as a float, not as UL */
+
+    if( P->Count == 0 ) { return( FALSE ); }
+
+    Newest = (P->Head - 1) & (ATT_PREDICT_DEPTH-1);
+    dt = (float)(int64_t)(Stamp - P->Stamp[Newest]) * (1.0f/(IPC_TICKS_PER_US*1.0e6f));
+
+    if( dt >  Max ) { dt =  Max; P->Stats.Clamped++; }
+    if( dt < -Max ) { dt = -Max; P->Stats.Clamped++; }
+
+    if( (P->Mode == ATT_PREDICT_HOLD) || (P->Count < 2) )
+    {
+        for( k=0; k<3; k++ ) { Rate[k] = 0; }
+    }
+    else
+    {
+        f_AttPredict_Slope( P, Rate );
+    }
+
+    for( k=0; k<3; k++ )
+    {
+        Angle[k] = f_WrapDeg( P->Angle[Newest][k] + Rate[k]*dt );
+    }
+
+    Out->Roll  = Angle[0];
+    Out->Pitch = Angle[1];
+    Out->Yaw   = Angle[2];
+
+    return( TRUE );
+} /* End f_AttPredict_Query */
+
+
+
+/*
+** f_AttPredict_Add
+** Add a checked sample taken at Stamp */
+void f_AttPredict_Add( ATT_PREDICT_TYPE *P, DATA_TYPE *Meas, Uint64 Stamp )
+{
+    int i, k;
+    Uint16 Newest;
+    float Meas_d[3], Err;
+
+    Meas_d[0] = Meas->Roll;
+    Meas_d[1] = Meas->Pitch;
+    Meas_d[2] = Meas->Yaw;
+
+    /* Unwrap against the newest sample, then store */
+    if( P->Count > 0 )
+    {
+        Newest = (P->Head - 1) & (ATT_PREDICT_DEPTH-1);
+        for( k=0; k<3; k++ )
+        {
+            Meas_d[k] = P->Angle[Newest][k] + f_WrapDeg( Meas_d[k] - P->Angle[Newest][k] );
+
+            /* Re-centre the axis by a whole turn so it can't grow without bound */
+            Err = (Meas_d[k] >= 180.0f) ? 360.0f : ((Meas_d[k] < -180.0f) ? -360.0f : 0.0f);
+            if( Err != 0 )
+            {
+                for( i=0; i<ATT_PREDICT_DEPTH; i++ ) { P->Angle[i][k] -= Err; }
+                Meas_d[k] -= Err;
+            }
+        }
+
+        /* Out of order or repeated stamp: drop the history, keep the sample */
+        if( Stamp <= P->Stamp[Newest] )
+        {
+            P->Count = 0;
+            P->Stats.Restarts++;
+        }
+    }
+
+    for( k=0; k<3; k++ ) { P->Angle[P->Head][k] = Meas_d[k]; }
+    P->Stamp[P->Head] = Stamp;
+    P->Head = (P->Head + 1) & (ATT_PREDICT_DEPTH-1);
+    if( P->Count < ATT_PREDICT_DEPTH ) { P->Count++; }
+} /* End f_AttPredict_Add */
+
+
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+#define ATT_PREDICT_CHECK_LEAD_US  5000UL    /* About a sample's age at the control update */
+#define ATT_PREDICT_CHECK_DT_US    10000UL   /* 100 Hz */
+
+/*
+** f_AttPredictTruth
+** The check trajectory at t (s), deg: roll and pitch swinging,
+** yaw turning at 90 deg/s through +-180 */
+static void f_AttPredictTruth( float t, float *Angle )
+{
+    Angle[0] = 30.0f*CMATH_SIN( 2.0f*3.14159265f*0.5f*t );
+    Angle[1] = 10.0f*CMATH_SIN( 2.0f*3.14159265f*0.2f*t );
+    Angle[2] = f_WrapDeg( 90.0f*t - 170.0f );
+} /* End f_AttPredictTruth */
+
+
+
+/*
+** f_AttPredict_Check
+** Run nSamples of the check trajectory through a predictor of its
+** own, in ATT_PREDICT_MODE. After each sample the attitude
+** ATT_PREDICT_CHECK_LEAD_US later is asked for and compared with
+** the trajectory itself. No noise, so this is the error of the
+** extrapolation alone */
+void f_AttPredict_Check( Uint16 nSamples )
+{
+    Uint16 i, k;
+    static ATT_PREDICT_TYPE P;   /* Not the one the control task uses */
+    DATA_TYPE Meas, Pred;
+    Uint64 Stamp;
+    float Truth[3], Pred_d[3], Err;
+
+    f_AttPredict_Init( &P, ATT_PREDICT_MODE );
+    memset( &g_AttPredictCheck, 0, sizeof(ATT_PREDICT_CHECK_TYPE) );
+    memset( &Meas, 0, sizeof(DATA_TYPE) );
+
+    for( i=0; i<nSamples; i++ )
+    {
+        Stamp = (Uint64)i*ATT_PREDICT_CHECK_DT_US*IPC_TICKS_PER_US;
+        f_AttPredictTruth( (float)i*(ATT_PREDICT_CHECK_DT_US*1.0e-6f), Truth );
+        Meas.Roll  = Truth[0];
+        Meas.Pitch = Truth[1];
+        Meas.Yaw   = Truth[2];
+        f_AttPredict_Add( &P, &Meas, Stamp );
+
+        /* Only once it can extrapolate */
+        if( P.Count < 2 ) { continue; }
+
+        f_AttPredict_Query( &P, Stamp + ATT_PREDICT_CHECK_LEAD_US*IPC_TICKS_PER_US, &Pred );
+        f_AttPredictTruth( (float)i*(ATT_PREDICT_CHECK_DT_US*1.0e-6f) + ATT_PREDICT_CHECK_LEAD_US*1.0e-6f, Truth );
+        Pred_d[0] = Pred.Roll;
+        Pred_d[1] = Pred.Pitch;
+        Pred_d[2] = Pred.Yaw;
+
+        for( k=0; k<3; k++ )
+        {
+            Err = fabsf( f_WrapDeg( Pred_d[k] - Truth[k] ) );
+            g_AttPredictCheck.ErrMean[k] += Err;
+            if( Err > g_AttPredictCheck.ErrMax[k] ) { g_AttPredictCheck.ErrMax[k] = Err; }
+        }
+        g_AttPredictCheck.Samples++;
+    }
+
+    for( k=0; k<3; k++ )
+    {
+        if( g_AttPredictCheck.Samples > 0 ) { g_AttPredictCheck.ErrMean[k] /= g_AttPredictCheck.Samples; }
+    }
+    g_AttPredictCheck.Lead_us = ATT_PREDICT_CHECK_LEAD_US;
+} /* End f_AttPredict_Check */
+#endif
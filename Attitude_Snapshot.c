@@ -0,0 +1,103 @@
+/*
+ * Attitude_Snapshot.c
+ *
+ *  Lock-free, double buffered attitude snapshot.
+ *  One writer (RX path, ISR or the link core) and any number of
+ *  readers (foreground, or the other core through message RAM).
+ *  See ATT_SNAPSHOT_TYPE in COMEX_Proj.h for the scheme.
+ */
+
+#include "COMEX_Proj.h"
+
+
+/* Snapshot shared between the RX path and foreground on this core */
+#pragma DATA_SECTION(g_AttSnapshot, "ComexHistory");
+ATT_SNAPSHOT_TYPE g_AttSnapshot;
+
+/* 16 bit words in a Type: its sizeof on the C28x, half of it in
+** a host build (tools/host) */
+#define SNAP_WORDS(Type) (sizeof(Type)/sizeof(Uint16))
+
+
+
+/*
+** f_CopyWords
+** Word copy which keeps every access to the shared buffer
+** volatile, so it cannot be moved across the Seq reads */
+static void f_CopyWords( volatile Uint16 *Src, volatile Uint16 *Dst, Uint16 nWords )
+{
+    Uint16 i;
+
+    for( i=0; i<nWords; i++ ) { Dst[i] = Src[i]; }
+} /* End f_CopyWords */
+
+
+
+/*
+** f_Snapshot_Init
+** Clear both buffers. A reader sees Seq == 0 until
+** the first sample is published */
+void f_Snapshot_Init( ATT_SNAPSHOT_TYPE *Snap )
+{
+    ATT_SAMPLE_TYPE Empty;
+
+    memset( &Empty, 0, sizeof(ATT_SAMPLE_TYPE) );
+
+    Snap->Seq = 0;
+    f_CopyWords( (volatile Uint16 *)&Empty, (volatile Uint16 *)&Snap->Buf[0], SNAP_WORDS(ATT_SAMPLE_TYPE) );
+    f_CopyWords( (volatile Uint16 *)&Empty, (volatile Uint16 *)&Snap->Buf[1], SNAP_WORDS(ATT_SAMPLE_TYPE) );
+} /* End f_Snapshot_Init */
+
+
+
+/*
+** f_Snapshot_Publish
+** Write a new sample without waiting on readers.
+** Must only be called from one context (ISR or one core).
+** Seq is 32 bit so the odd/even update is a single MOVL */
+void f_Snapshot_Publish( ATT_SNAPSHOT_TYPE *Snap, DATA_TYPE *Data, Uint16 ErrorCount )
+{
+    Uint32 Seq = Snap->Seq;
+    volatile ATT_SAMPLE_TYPE *p_Buf = &Snap->Buf[(Seq >> 1) & 1];
+
+    /* Odd: p_Buf is being written */
+    Snap->Seq = Seq + 1;
+
+    p_Buf->Seq        = (Seq >> 1) + 1;
+    p_Buf->ErrorCount = ErrorCount;
+    p_Buf->Stamp      = ReadIpcTimer();
+    f_CopyWords( (volatile Uint16 *)Data, (volatile Uint16 *)&p_Buf->Data, SNAP_WORDS(DATA_TYPE) );
+
+    /* Even: p_Buf is now the stable buffer */
+    Snap->Seq = Seq + 2;
+} /* End f_Snapshot_Publish */
+
+
+
+/*
+** f_Snapshot_Read
+** Copy out the last complete sample.
+** The buffer we copy is only rewritten once the writer has
+** started two more publishes, so the copy is good as long as
+** Seq has not moved past the next even value.
+** Returns the number of attempts used, 0 if every attempt
+** was torn (Sample is then left with the last torn copy) */
+Uint16 f_Snapshot_Read( ATT_SNAPSHOT_TYPE *Snap, ATT_SAMPLE_TYPE *Sample )
+{
+    Uint16 Attempt;
+    Uint32 Seq1, Seq2;
+
+    for( Attempt=1; Attempt<=SNAPSHOT_MAX_RETRIES; Attempt++ )
+    {
+        Seq1 = Snap->Seq;
+
+        f_CopyWords( (volatile Uint16 *)&Snap->Buf[((Seq1 >> 1) + 1) & 1],
+                     (volatile Uint16 *)Sample, SNAP_WORDS(ATT_SAMPLE_TYPE) );
+
+        Seq2 = Snap->Seq;
+
+        if( (Uint32)(Seq2 - (Seq1 & ~1UL)) <= 2 ) { return( Attempt ); }
+    }
+
+    return( 0 );
+} /* End f_Snapshot_Read */
@@ -15,6 +15,12 @@
 *************************** Globals ****************************************
 ****************************************************************************/
 
+LINK_TYPE g_Links[LINK_NPORTS];  /* Indexed by SCI port, only COMEX_IMU_PORTS used; .ebss */
+Uint16    g_LinkPrimary;        /* Port whose samples drive the attitude */
+DATA_TYPE g_AttControl;         /* Attitude for the control tick (deg) */
+#if COMEX_TEST_PACKET
+Uint16    g_TestPacketErrors;   /* Failed packets of the start up test, f_TestPacket */
+#endif
 
 
 
@@ -22,27 +28,150 @@
 /***************************************************************************
 *************************** Function Prototypes ****************************
 ****************************************************************************/
+#if COMEX_TEST_PACKET
 int f_TestPacket( void );
+#endif
+void f_LinkLoop( void );
+void f_ProcessSample( DATA_TYPE *Data, RESPONSE_TYPE *Response, Uint16 ErrorCount );
+void f_LinkService( void );
+void f_LinkStep( LINK_TYPE *Link );
+Uint16 f_LinkRequest( LINK_TYPE *Link );
+bool f_LinkClipped( RESPONSE_TYPE *Response );
+Uint16 f_LinkPrepare( LINK_TYPE *Link, unsigned char *Req );
+void f_LinkSend( LINK_TYPE *Link );
+void f_LinkAccept( LINK_TYPE *Link, PKT_BLOCK_TYPE *Block, DATA_TYPE *Data, RESPONSE_TYPE *Response );
+void f_LinkDeliver( LINK_TYPE *Link, DATA_TYPE *Data, RESPONSE_TYPE *Response );
+#if COMEX_USE_ARQ
+void f_LinkArqDeliver( LINK_TYPE *Link, PKT_BLOCK_TYPE *Block, Uint64 Stamp );
+void f_LinkArqDrain( LINK_TYPE *Link );
+#endif
+void f_LinkFailover( void );
+void f_ControlTask( void );
 
 /***************************************************************************
 *************************** Main Start *************************************
 ****************************************************************************/
 
+#if defined(CPU1)
 void main( void )
 {
-   int ErrorCount = 0;
+#if COMEX_IMU_ON_CPU2
+   ATT_SAMPLE_TYPE Sample;
+   ATT_SAMPLE_TYPE Stream[IPC_MBX_BATCH];
+   Uint16 nStream;
+#endif
 
    f_Initialize();
+#if COMEX_USE_SUPERVISOR
+   f_Super_Init();     // Reset cause, retained statistics
+#endif
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+   f_Parser_Benchmark( 100 );
+#if COMEX_USE_ATT_FILTER
+   f_AttFilter_Benchmark( 100 );
+#endif
+#if COMEX_USE_FEC
+   f_Fec_Benchmark( 100 );
+#endif
+#if COMEX_USE_ARQ
+   f_Arq_Check( 1000 );
+#endif
+#if COMEX_USE_TIME_SYNC
+   f_TimeSync_Check( 2000 );
+#endif
+#if COMEX_USE_ATT_PREDICT
+   f_AttPredict_Check( 1000 );
+#endif
+#endif
+
+#if COMEX_USE_ATT_FILTER
+   f_AttFilter_Init( &g_AttFilter, ATT_FILTER_KP, ATT_FILTER_KI );
+#endif
+#if COMEX_USE_ATT_PREDICT
+   f_AttPredict_Init( &g_AttPredict, ATT_PREDICT_MODE );
+#endif
+
+#if COMEX_IMU_ON_CPU2
+   /* CPU2 runs the IMU link, we only consume samples */
+   f_IpcLink_Init();
+   f_GiveImuToCpu2();
+
+   for(;;)
+   {
+       if( f_IpcLink_Receive( &Sample ) )
+       {
+           /* Both cores share the IPC counter, so CPU2's stamp is valid here */
+#if COMEX_USE_ATT_FILTER
+           f_AttFilter_Correct( &g_AttFilter, &Sample.Data, Sample.Data.SampleStamp );
+#endif
+#if COMEX_USE_ATT_PREDICT
+           f_AttPredict_Add( &g_AttPredict, &Sample.Data, Sample.Data.SampleStamp );
+#endif
+           /* Control code consumes Sample.Data here */
+       }
+
+       /* Full sample stream, looked at once per IPC_FLAG_MBX */
+       nStream = f_IpcMbx_Get( Stream, IPC_MBX_BATCH );
+       f_IpcMbx_Log( Stream, nStream );
+   }
+#else
+   f_Snapshot_Init( &g_AttSnapshot );
+   f_AttPost_Init( ATT_MOUNT_YAW, ATT_POST_ALPHA );
+
+   f_ImuPorts_Open();  // SCI, FIFO and handshake of every IMU port
+   f_Link_Init();      // Receive (and timestamp) from here on in the ISRs
+#if COMEX_USE_TELEMETRY
+   f_Telem_Init();
+#endif
+   EINT;
+
+#if COMEX_TEST_PACKET
+   g_TestPacketErrors = f_TestPacket();
+#endif
+
+   /* Everything from here on runs off the executive tick */
+   f_Exec_Init();
+   f_Exec_Add( &f_LinkService, EXEC_PERIOD_LINK,    0 );
+   f_Exec_Add( &f_ControlTask, EXEC_PERIOD_CONTROL, 0 );
+#if COMEX_USE_TELEMETRY
+   f_Exec_Add( &f_Telem_Task,  TELEM_DECIMATION,    0 );
+#endif
+#if COMEX_USE_SUPERVISOR
+   f_Exec_Add( &f_Super_Task,  EXEC_PERIOD_SUPER,   0 );  // Last, sees the whole cycle
+   f_Super_Start();    // Watchdog on from here
+#endif
+   f_Exec_Start();
+
+   for(;;)
+   {
+       f_Exec_Run();
+   }
+#endif
+}
+
+#elif defined(CPU2)
+void main( void )
+{
+   f_Initialize();
+   f_IpcLink_Init();
 
-   f_fifo_init();  // Initialize the SCI FIFO
-   f_sci_init();   // Initialize SCI
+   f_AttPost_Init( ATT_MOUNT_YAW, ATT_POST_ALPHA );
 
-   /* Handshake w/ IMU to sync baud rate */
-   //g_IMU_state.BaudLock=false;
-   //f_Handshake();
+   /* Wait for CPU1 to release the IMU port and its pins to us.
+   ** Without them there is nothing to do, so keep trying */
+   while( f_IpcFlag_Wait( IPC_FLAG_BOOT_SYNC, IPC_SYNC_TIMEOUT_US ) != IO_OK )
+   {
+       g_IpcLinkStats.SyncTimeouts++;
+   }
 
-   ErrorCount = f_TestPacket();
+   f_ImuPorts_Open();
+   f_Link_Init();
+   EINT;
+
+   f_LinkLoop();
 }
+#endif
 
 
 
@@ -52,13 +181,12 @@ void main( void )
 *************************** Functions **************************************
 ****************************************************************************/
 
+#if COMEX_TEST_PACKET
 int f_TestPacket( void )
 {
     Uint16 LoopCount;
     Uint16 ErrorCount;
-    unsigned char myChecksum;
-
-
+    SCI_PORT_TYPE *Port = &g_SciPorts[COMEX_IMU_PRIMARY];
 
     RESPONSE_TYPE Response;
     DATA_TYPE Data;
@@ -67,6 +195,8 @@ int f_TestPacket( void )
     uint16_t SendChar = 0xB2; /* Debug float */
     //uint16_t SendChar = 0xA1; /* Request 3 x 16 bit floats */
     //uint16_t SendChar = 0xA2; /* Request 3 x 32 bit floats */
+    //uint16_t SendChar = 0xA3; /* Request quaternion, 4 x Q14 */
+    //uint16_t SendChar = 0xA4; /* Request quaternion, 4 x 32 bit floats */
 
     /* User specific code: */
     LoopCount   = 0;
@@ -75,25 +205,629 @@ int f_TestPacket( void )
     /* Test */
     while( LoopCount<1000 )
     {
+        LoopCount++;
+
         /* Send test init character */
-        while (ScibRegs.SCICTL2.bit.TXEMPTY == 0) {}
-        ScibRegs.SCITXBUF.all = SendChar;
+        if( f_WaitTxEmpty( Port, f_Deadline_Set( TX_TIMEOUT_US ) ) != IO_OK ) { ErrorCount++; continue; }
+        f_xmit_char( Port, SendChar );
 
         /* Get data packet */
-        f_GetPacket( &Data, &Response );
+        if( f_GetPacket( Port, &Data, &Response, LINK_TIMEOUT_US ) != IO_OK )
+        {
+            g_Links[COMEX_IMU_PRIMARY].Stats.Timeouts++;
+            ErrorCount++;
+            continue;
+        }
+
+        if( f_PacketOk( &Response ) == FALSE ) { ErrorCount++; }
+        else if( f_AttPost_Run( &g_Links[COMEX_IMU_PRIMARY].Post, &Response, &Data ) == FALSE ) { ErrorCount++; }
+        else
+        {
+            f_ProcessSample( &Data, &Response, ErrorCount );
+        }
+    }
 
-        /* Calculate checksum of data */
-        myChecksum = f_CheckSum( &Response.Buffer[0], Response.Buffer_nBytes );
+    return( ErrorCount );
+} /* End f_TestPacket */
+#endif
 
-        if( myChecksum != Response.CheckSum ) { ErrorCount++; }
 
-        LoopCount++;
+
+/*
+** f_ProcessSample
+** Hand a checked packet to everything that consumes samples */
+void f_ProcessSample( DATA_TYPE *Data, RESPONSE_TYPE *Response, Uint16 ErrorCount )
+{
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+    if( g_BootTimes.Stamp[BOOT_STAGE_FIRST_SAMPLE] == 0 )
+    {
+        f_BootStage( BOOT_STAGE_FIRST_SAMPLE );
+        f_BootReport();
     }
+#endif
 
-    return( ErrorCount );
-} /* End f_TestPacket */
+    f_Snapshot_Publish( &g_AttSnapshot, Data, ErrorCount );
+
+    if( (Response->PacketType >= 1) && (Response->PacketType <= 6) )
+    {
+#if COMEX_USE_ATT_FILTER
+        f_AttFilter_Correct( &g_AttFilter, Data, Data->SampleStamp );
+#endif
+#if COMEX_USE_ATT_PREDICT
+        f_AttPredict_Add( &g_AttPredict, Data, Data->SampleStamp );
+#endif
+    }
+} /* End f_ProcessSample */
+
+
+
+/*
+** f_ImuPorts_Open
+** SCI and FIFO set up of every IMU port and the bridge port,
+** then the handshake
+** with each IMU in turn (polled, before the RX interrupts) */
+void f_ImuPorts_Open( void )
+{
+    Uint16 Id;
+#if COMEX_USE_HANDSHAKE
+    IMU_STATE_TYPE g_IMU_state;
+#endif
+
+    for( Id=0; Id<SCI_NPORTS; Id++ )
+    {
+        if( (COMEX_IMU_PORTS & (1 << Id)) == 0 ) { continue; }
+        f_fifo_init( &g_SciPorts[Id] );            // Initialize the SCI FIFO
+        f_sci_init( &g_SciPorts[Id], SCI_BAUD );   // Initialize SCI
+    }
+#if COMEX_USE_BRIDGE
+    f_fifo_init( &g_SciPorts[COMEX_BRIDGE_PORT] );
+    f_sci_init( &g_SciPorts[COMEX_BRIDGE_PORT], COMEX_BRIDGE_BAUD );
+#endif
+    f_BootStage( BOOT_STAGE_SCI );
+
+#if COMEX_USE_HANDSHAKE
+    /* Handshake w/ IMU to sync baud rate */
+    for( Id=0; Id<SCI_NPORTS; Id++ )
+    {
+        if( (COMEX_IMU_PORTS & (1 << Id)) == 0 ) { continue; }
+        g_IMU_state.BaudLock=false;
+        f_Handshake( &g_SciPorts[Id], g_IMU_state, HANDSHAKE_TIMEOUT_US );
+    }
+    f_BootStage( BOOT_STAGE_HANDSHAKE );
+#endif
+} /* End f_ImuPorts_Open */
+
+
+
+/*
+** f_Link_Init
+** Reset the link state of every IMU port and move its
+** reception onto the RX interrupt */
+void f_Link_Init( void )
+{
+    Uint16 Id;
+
+    memset( g_Links, 0, sizeof(g_Links) );
+    g_LinkPrimary = COMEX_IMU_PRIMARY;
+
+    for( Id=0; Id<LINK_NPORTS; Id++ )
+    {
+        if( (COMEX_IMU_PORTS & (1 << Id)) == 0 ) { continue; }
+        g_Links[Id].Port  = &g_SciPorts[Id];
+        g_Links[Id].State = LINK_IDLE;
+        f_TimeSync_Init( &g_Links[Id].Sync );
+#if COMEX_USE_ADAPTIVE_POLL
+        f_PollRate_Init( &g_Links[Id].Poll, &g_SciPorts[Id] );
+#endif
+#if COMEX_USE_ARQ
+        f_Arq_Init( &g_Links[Id].Arq );
+#endif
+        f_rx_isr_init( &g_SciPorts[Id] );
+    }
+
+#if COMEX_USE_BRIDGE
+    f_SciPort_Bridge( &g_SciPorts[COMEX_BRIDGE_FROM], &g_SciPorts[COMEX_BRIDGE_PORT] );
+#endif
+} /* End f_Link_Init */
+
+
+
+/*
+** f_Link_Rebuild
+** Bring a stalled link back without a reset: stop the port,
+** set the SCI up from scratch, handshake again (bounded by
+** RECOVER_HANDSHAKE_US) and restart reception */
+void f_Link_Rebuild( LINK_TYPE *Link )
+{
+    SCI_PORT_TYPE *Port = Link->Port;
+#if COMEX_USE_HANDSHAKE
+    IMU_STATE_TYPE IMU_state;
+#endif
+
+#if COMEX_USE_PWM_SYNC
+    Link->SyncArmed = FALSE;   // Nothing for the ePWM2 ISR to send meanwhile
+#endif
+    f_SciPort_Stop( Port );
+    f_fifo_init( Port );
+    f_sci_init( Port, SCI_BAUD );
+#if COMEX_USE_HANDSHAKE
+    IMU_state.BaudLock = false;
+    f_Handshake( Port, IMU_state, RECOVER_HANDSHAKE_US );
+#endif
+    f_rx_isr_init( Port );
+#if COMEX_USE_ADAPTIVE_POLL
+    f_PollRate_Init( &Link->Poll, Port );   // The IMU may come back different
+#endif
+
+#if COMEX_USE_PWM_SYNC
+    Link->SyncSeen = Link->SyncSent;
+#endif
+    Link->Post.Count = 0;   // No low pass across the outage
+    Link->State = LINK_IDLE;
+    Link->Stats.Rebuilds++;
+} /* End f_Link_Rebuild */
+
+
+
+/*
+** f_LinkService
+** Executive task: one step of every IMU link, then make sure
+** the primary link is still delivering */
+void f_LinkService( void )
+{
+    Uint16 Id;
+
+    for( Id=0; Id<LINK_NPORTS; Id++ )
+    {
+        if( COMEX_IMU_PORTS & (1 << Id) ) { f_LinkStep( &g_Links[Id] ); }
+    }
+
+    f_LinkFailover();
+} /* End f_LinkService */
+
+
+
+/*
+** f_LinkRequest
+** Request character for the link's next packet. LINK_REQUEST,
+** or with LINK_REQUEST_AUTO the compact Q7 Euler packet (0xA1)
+** whenever it will do, the float one (0xA2) when it won't:
+** Q7 too coarse for LINK_PRECISION_DEG, an angle near the end of
+** its +-256 deg range, or too little of the round trip saved */
+Uint16 f_LinkRequest( LINK_TYPE *Link )
+{
+#if LINK_REQUEST == LINK_REQUEST_AUTO
+    float Limit = LINK_Q7_RANGE_DEG - LINK_AUTO_MARGIN_DEG;
+#if COMEX_USE_ADAPTIVE_POLL
+    float Saved_us;
+#endif
+
+    if( LINK_Q7_LSB_DEG/2 > LINK_PRECISION_DEG ) { return( 0xA2 ); }
+
+    /* Angles unknown, or they just ran off the end */
+    if( (Link->LastGood == 0) || Link->Clipped ) { return( 0xA2 ); }
+
+    if( (fabsf( Link->Sample.Roll  ) >= Limit) ||
+        (fabsf( Link->Sample.Pitch ) >= Limit) ||
+        (fabsf( Link->Sample.Yaw   ) >= Limit) )
+    {
+        return( 0xA2 );
+    }
+
+#if COMEX_USE_ADAPTIVE_POLL
+    /* The IMU's turnaround dominates, the shorter packet buys no rate */
+    Saved_us = (float)(LINK_Q7_SAVED_BYTES*FEC_EXPANSION*Link->Port->ByteTicks) * (1.0f/IPC_TICKS_PER_US);
+    if( (Link->Poll.Stats.Samples > 0) && (Saved_us < LINK_AUTO_MIN_GAIN*Link->Poll.Srtt_us) )
+    {
+        return( 0xA2 );
+    }
+#endif
+
+    Link->Stats.Compact++;
+    return( 0xA1 );
+#else
+    return( LINK_REQUEST );
+#endif
+} /* End f_LinkRequest */
+
+
+
+/*
+** f_LinkClipped
+** TRUE for a Q7 answer with an angle at the end of the Q7 range,
+** which an IMU saturating there sends for anything beyond it.
+** Read off the raw Q7 words, the angles may not be scaled yet */
+bool f_LinkClipped( RESPONSE_TYPE *Response )
+{
+#if LINK_REQUEST == LINK_REQUEST_AUTO
+    int i;
+    unsigned int Word;
+    int16_t Limit = (int16_t)((LINK_Q7_RANGE_DEG - LINK_Q7_LSB_DEG) / LINK_Q7_LSB_DEG);
+
+    if( Response->PacketType != 1 ) { return( FALSE ); }
+
+    for( i=0; i<3; i++ )
+    {
+        f_UnpackInt_u16( &Response->Buffer[SFLOAT*i], &Word );
+        if( ((int16_t)Word >= Limit) || ((int16_t)Word <= -Limit) ) { return( TRUE ); }
+    }
+    return( FALSE );
+#else
+    return( FALSE );
+#endif
+} /* End f_LinkClipped */
+
+
+
+/*
+** f_LinkStep
+** One non blocking step of a link's request/response cycle.
+** Sends a request when idle (and, with COMEX_USE_ADAPTIVE_POLL,
+** once the link's request interval is up; with COMEX_USE_PWM_SYNC
+** it arms one for the ePWM2 ISR to send on the beat), then waits (over as
+** many ticks as it takes) for the RX ISR to frame the answer,
+** giving up after LINK_TIMEOUT_US (or the link's measured
+** timeout). Good samples of the primary link go on to
+** f_ProcessSample, every link keeps its last one in Link->Sample */
+void f_LinkStep( LINK_TYPE *Link )
+{
+    PKT_BLOCK_TYPE *Block;
+    RESPONSE_TYPE Response;
+    DATA_TYPE Data;
 
+    switch( Link->State )
+    {
+      case LINK_IDLE:
+#if COMEX_USE_PWM_SYNC
+        /* The ePWM2 ISR sends the armed request (below), the lead
+        ** before this tick. Once it has, on to the answer, which
+        ** should be in already */
+        if( Link->SyncSent == Link->SyncSeen ) { break; }
+        Link->SyncSeen = Link->SyncSent;
+#if COMEX_USE_ADAPTIVE_POLL
+        Link->Deadline  = f_Deadline_Set( f_PollRate_Sent( &Link->Poll ) );
+        Link->Poll.Sent = Link->SyncStamp;
+#else
+        Link->Deadline  = f_Deadline_Set( LINK_TIMEOUT_US );
+#endif
+        Link->State     = LINK_WAIT;
+        Link->Stats.Requests++;
+        /* Fall through */
+#else
+        if( Link->Port->Regs->SCICTL2.bit.TXEMPTY == 0 ) { break; }
+#if COMEX_USE_ADAPTIVE_POLL
+        if( f_PollRate_Due( &Link->Poll ) == FALSE ) { break; }
+        f_LinkSend( Link );
+        Link->Deadline = f_Deadline_Set( f_PollRate_Sent( &Link->Poll ) );
+#else
+        f_LinkSend( Link );
+        Link->Deadline = f_Deadline_Set( LINK_TIMEOUT_US );
+#endif
+        Link->State    = LINK_WAIT;
+        Link->Stats.Requests++;
+        break;
+#endif
+
+      case LINK_WAIT:
+        Block = f_RxFrameTake( Link->Port );
+        if( Block == 0 )
+        {
+            if( f_Deadline_Expired( Link->Deadline ) )
+            {
+                Link->Stats.Timeouts++;
+#if COMEX_USE_ADAPTIVE_POLL
+                f_PollRate_Error( &Link->Poll, TRUE );
+#endif
+                Link->State = LINK_IDLE;
+            }
+            break;
+        }
+
+        memset( &Data, 0, sizeof(DATA_TYPE) );
+        f_DecodePacket( &Block->Frame, &Data, &Response );
+
+        if( f_PacketOk( &Response ) == FALSE )
+        {
+            f_PktPool_Free( Block );
+            Link->Stats.BadChecksum++;
+            Link->Errors++;
+#if COMEX_USE_ADAPTIVE_POLL
+            f_PollRate_Error( &Link->Poll, FALSE );
+#endif
+        }
+        else
+        {
+            Link->Stats.Good++;
+            Link->LastGood = ReadIpcTimer();
+#if COMEX_USE_ADAPTIVE_POLL
+            f_PollRate_Answer( &Link->Poll, Link->Port, &Data );
+#endif
+#if COMEX_USE_SUPERVISOR
+            if( Link->Rebuilds > 0 ) { f_Super_Recovered( Link ); }
+#endif
+            f_LinkAccept( Link, Block, &Data, &Response );
+        }
+        Link->State = LINK_IDLE;
+        break;
+    }
+
+#if COMEX_USE_ARQ
+    /* Frames held behind a gap which has run out of time */
+    f_LinkArqDrain( Link );
+#endif
+#if COMEX_USE_PWM_SYNC
+    /* Idle again: arm the next request for the coming beat */
+    if( (Link->State == LINK_IDLE) && (Link->SyncArmed == FALSE) && (Link->SyncSent == Link->SyncSeen) )
+    {
+        Link->SyncLen   = f_LinkPrepare( Link, Link->SyncReq );
+        Link->SyncArmed = TRUE;
+    }
+#endif
+} /* End f_LinkStep */
 
 
 
+/*
+** f_LinkPrepare
+** The bytes of the link's next request into Req, or with
+** COMEX_USE_ARQ a NAK for the oldest gap in its sequence numbers
+** if there is one. Returns how many (LINK_REQ_MAX at most) */
+Uint16 f_LinkPrepare( LINK_TYPE *Link, unsigned char *Req )
+{
+#if COMEX_USE_ARQ
+    Uint16 Seq;
+
+    if( f_Arq_Nak( &Link->Arq, &Seq ) )
+    {
+        Req[0] = ARQ_NAK;
+        Req[1] = Seq >> 8;
+        Req[2] = Seq & 0xFF;
+        return( 3 );
+    }
+#endif
+    Req[0] = f_LinkRequest( Link );
+    return( 1 );
+} /* End f_LinkPrepare */
+
+
+
+/*
+** f_LinkSend
+** Send the link's next request (f_LinkPrepare) now */
+void f_LinkSend( LINK_TYPE *Link )
+{
+    unsigned char Req[LINK_REQ_MAX];
+    Uint16 i, n;
+
+    n = f_LinkPrepare( Link, Req );
+    for( i=0; i<n; i++ ) { f_xmit_char( Link->Port, Req[i] ); }
+} /* End f_LinkSend */
+
+
+
+/*
+** f_LinkAccept
+** A good packet in its pool block. Sequence numbered packets go
+** through the link's ARQ window (which keeps the block until they
+** are due), the rest straight on to f_LinkDeliver */
+void f_LinkAccept( LINK_TYPE *Link, PKT_BLOCK_TYPE *Block, DATA_TYPE *Data, RESPONSE_TYPE *Response )
+{
+#if COMEX_USE_ARQ
+    PKT_BLOCK_TYPE *Held;
+    Uint64 Stamp;
+
+    if( Data->HasSeq )
+    {
+        while( f_Arq_Room( &Link->Arq, Data->Seq ) == FALSE )
+        {
+            Held = f_Arq_Get( &Link->Arq, ReadIpcTimer(), TRUE, &Stamp );
+            if( Held != 0 ) { f_LinkArqDeliver( Link, Held, Stamp ); }
+        }
+        if( f_Arq_Put( &Link->Arq, Data->Seq, Block, Data->RxFirstStamp ) == FALSE )
+        {
+            f_PktPool_Free( Block );
+        }
+        f_LinkArqDrain( Link );
+        return;
+    }
+#endif
+
+    f_PktPool_Free( Block );
+    f_LinkDeliver( Link, Data, Response );
+} /* End f_LinkAccept */
+
+
+
+/*
+** f_LinkDeliver
+** A good sample, in order: time it, keep it, and if the link is
+** the primary hand it on */
+void f_LinkDeliver( LINK_TYPE *Link, DATA_TYPE *Data, RESPONSE_TYPE *Response )
+{
+#if COMEX_USE_TIME_SYNC
+    f_TimeSync_Sample( &Link->Sync, Data );
+#endif
+    Link->Clipped = f_LinkClipped( Response );
+    if( Link->Clipped )
+    {
+        Link->Stats.Clipped++;
+        return;
+    }
+    if( f_AttPost_Run( &Link->Post, Response, Data ) == FALSE ) { return; }
+
+    Link->Sample = *Data;
+    if( Link->Port->Id == g_LinkPrimary )
+    {
+        f_ProcessSample( Data, Response, Link->Errors );
+    }
+} /* End f_LinkDeliver */
+
+
+
+#if COMEX_USE_ARQ
+/*
+** f_LinkArqDeliver
+** A frame out of the ARQ window: decode it again, date it when it
+** was due and deliver it */
+void f_LinkArqDeliver( LINK_TYPE *Link, PKT_BLOCK_TYPE *Block, Uint64 Stamp )
+{
+    RESPONSE_TYPE Response;
+    DATA_TYPE Data;
 
+    memset( &Data, 0, sizeof(DATA_TYPE) );
+    f_DecodePacket( &Block->Frame, &Data, &Response );
+    f_PktPool_Free( Block );
+
+    Data.SampleStamp = Stamp;
+    f_LinkDeliver( Link, &Data, &Response );
+} /* End f_LinkArqDeliver */
+
+
+
+/*
+** f_LinkArqDrain
+** Deliver every frame of the ARQ window which is due */
+void f_LinkArqDrain( LINK_TYPE *Link )
+{
+    PKT_BLOCK_TYPE *Held;
+    Uint64 Stamp;
+
+    while( (Held = f_Arq_Get( &Link->Arq, ReadIpcTimer(), FALSE, &Stamp )) != 0 )
+    {
+        f_LinkArqDeliver( Link, Held, Stamp );
+    }
+} /* End f_LinkArqDrain */
+#endif
+
+
+
+/*
+** f_LinkFailover
+** Once the primary link has gone LINK_STALE_US without a good
+** packet, hand the primary role to the first other IMU link
+** which has had one within that time */
+void f_LinkFailover( void )
+{
+    Uint16 Id;
+    Uint64 Now   = ReadIpcTimer();
+    Uint64 Stale = (Uint64)LINK_STALE_US*IPC_TICKS_PER_US;
+
+    if( Now - g_Links[g_LinkPrimary].LastGood < Stale ) { return; }
+
+    for( Id=0; Id<LINK_NPORTS; Id++ )
+    {
+        if( ((COMEX_IMU_PORTS & (1 << Id)) == 0) || (Id == g_LinkPrimary) ) { continue; }
+        if( (g_Links[Id].LastGood != 0) && (Now - g_Links[Id].LastGood < Stale) )
+        {
+            g_Links[g_LinkPrimary].Stats.Failovers++;
+            g_LinkPrimary = Id;
+            return;
+        }
+    }
+} /* End f_LinkFailover */
+
+
+
+/*
+** f_ControlTask
+** Executive task: bring the attitude up to the current tick
+** for the control law */
+void f_ControlTask( void )
+{
+    Uint64 Now = ReadIpcTimer();
+
+#if COMEX_USE_PWM_SYNC
+    f_PwmSync_Control( Now );
+#endif
+#if COMEX_USE_ATT_PREDICT
+    f_AttPredict_Query( &g_AttPredict, Now, &g_AttControl );
+#elif COMEX_USE_ATT_FILTER
+    if( g_AttFilter.Valid ) { f_AttFilter_Estimate( &g_AttFilter, Now, &g_AttControl ); }
+#endif
+
+    /* Control law consumes g_AttControl here */
+} /* End f_ControlTask */
+
+
+
+/*
+** f_LinkLoop
+** Run the IMU request/response loop forever and publish
+** every decoded sample to the other core */
+void f_LinkLoop( void )
+{
+    Uint16 ErrorCount;
+    SCI_PORT_TYPE *Port = &g_SciPorts[COMEX_IMU_PRIMARY];
+
+    RESPONSE_TYPE Response;
+    DATA_TYPE Data;
+
+    LINK_TYPE *Link = &g_Links[COMEX_IMU_PRIMARY];
+    Uint32 Timeout_us = LINK_TIMEOUT_US;
+#if COMEX_USE_ADAPTIVE_POLL
+    POLL_RATE_TYPE *Poll = &Link->Poll;
+
+    f_PollRate_Init( Poll, Port );
+#endif
+
+    ErrorCount = 0;
+    memset( &Data, 0, sizeof(DATA_TYPE) );
+
+    for(;;)
+    {
+        f_IpcMbx_Poll( FALSE );
+
+        /* Send request character */
+        if( f_WaitTxEmpty( Port, f_Deadline_Set( TX_TIMEOUT_US ) ) != IO_OK ) { ErrorCount++; continue; }
+#if COMEX_USE_ADAPTIVE_POLL
+        while( f_PollRate_Due( Poll ) == FALSE ) {}
+        f_xmit_char( Port, f_LinkRequest( Link ) );
+        Timeout_us = f_PollRate_Sent( Poll );
+#else
+        f_xmit_char( Port, f_LinkRequest( Link ) );
+#endif
+
+        /* Get data packet. A lost byte costs one timeout, then we ask again */
+        if( f_GetPacket( Port, &Data, &Response, Timeout_us ) != IO_OK )
+        {
+            Link->Stats.Timeouts++;
+#if COMEX_USE_ADAPTIVE_POLL
+            f_PollRate_Error( Poll, TRUE );
+#endif
+            f_IpcMbx_Poll( TRUE );   // Nothing is coming, don't hold the stream back
+            ErrorCount++;
+            continue;
+        }
+
+        if( f_PacketOk( &Response ) == FALSE )
+        {
+#if COMEX_USE_ADAPTIVE_POLL
+            f_PollRate_Error( Poll, FALSE );
+#endif
+            ErrorCount++;
+            continue;
+        }
+#if COMEX_USE_ADAPTIVE_POLL
+        f_PollRate_Answer( Poll, Port, &Data );
+#endif
+
+        Link->Clipped = f_LinkClipped( &Response );
+        if( Link->Clipped ) { Link->Stats.Clipped++; continue; }
+        if( f_AttPost_Run( &Link->Post, &Response, &Data ) == FALSE ) { ErrorCount++; continue; }
+        Link->LastGood = ReadIpcTimer();
+        Link->Sample   = Data;
+
+#if COMEX_USE_TIME_SYNC
+        f_TimeSync_Sample( &Link->Sync, &Data );
+#endif
+        f_IpcLink_Publish( &Data, ErrorCount );
+
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+        if( g_BootTimes.Stamp[BOOT_STAGE_FIRST_SAMPLE] == 0 )
+        {
+            f_BootStage( BOOT_STAGE_FIRST_SAMPLE );
+            f_BootReport();
+        }
+#endif
+    }
+} /* End f_LinkLoop */
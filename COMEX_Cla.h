@@ -0,0 +1,67 @@
+/*
+ * COMEX_Cla.h
+ *
+ *  Data shared between the C28x and the CLA attitude task.
+ *  Included by both compilers: only fixed width types here
+ *  (int is 16 bit on the C28x but 32 bit on the CLA).
+ */
+
+#ifndef COMEX_CLA_H_
+#define COMEX_CLA_H_
+
+#include "F2837xD_Cla_typedefs.h"
+#include <stdint.h>
+
+
+/* Q-format of the 16 bit RPY packet (type 1) */
+#define CLA_Q7_SCALE  (1.0f/128.0f)
+
+/* Max CLA vs reference difference (deg) before we count a mismatch */
+#define CLA_CHECK_TOL 1.0e-4f
+
+
+/* Filter state of one IMU. The C28x keeps it per link and it
+** goes through the task with each sample, so the CLA holds no
+** state of its own */
+typedef struct
+{
+    float    Roll;        /* Filtered, in [-180,180) (deg) */
+    float    Pitch;
+    float    Yaw;
+    uint32_t Count;       /* Samples since the restart, 0 restarts */
+} CLA_ATT_STATE_TYPE;
+
+/* Written by the C28x in CpuToCla1MsgRAM */
+typedef struct
+{
+    uint16_t PacketType;  /* 1: RawQ7 is valid, 2: RawF32 is valid */
+    int16_t  RawQ7[3];    /* Roll, pitch, yaw as sent (Q7) */
+    float    RawF32[3];   /* Roll, pitch, yaw as sent (float) */
+
+    float    Alpha;       /* Low pass coefficient, 1 = no filtering */
+    float    MountCos;    /* Cos/sin of the IMU mounting yaw, used to */
+    float    MountSin;    /* rotate the tilt pair into the body frame */
+    float    YawOffset;   /* Mounting yaw (deg) */
+
+    CLA_ATT_STATE_TYPE State;  /* The link's state before this sample */
+} CLA_ATT_IN_TYPE;
+
+/* Written by the CLA in Cla1ToCpuMsgRAM */
+typedef struct
+{
+    float    Roll;        /* Body frame, filtered, folded into [-180,180) (deg) */
+    float    Pitch;
+    float    Yaw;         /* Filtered, folded into [-180,180) (deg) */
+
+    CLA_ATT_STATE_TYPE State;  /* The link's state after it */
+} CLA_ATT_OUT_TYPE;
+
+
+extern CLA_ATT_IN_TYPE  g_ClaAttIn;
+extern CLA_ATT_OUT_TYPE g_ClaAttOut;
+
+/* CLA tasks */
+__interrupt void Cla1Task1( void );
+
+
+#endif /* COMEX_CLA_H_ */
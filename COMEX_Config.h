@@ -0,0 +1,341 @@
+/*
+ * COMEX_Config.h
+ *
+ *  Build configuration: which features and packet types are built,
+ *  buffer depths, link baud, integrity check and instrumentation.
+ *  Anything switched off here compiles out entirely, code and RAM.
+ *
+ *  COMEX_CONFIG picks a preset. FULL (the default) is the
+ *  development build. Define COMEX_CONFIG=COMEX_CONFIG_LEAN in a
+ *  build configuration (--define) for the flight build.
+ *  tools/size_report.py compares the linkInfo of the two builds.
+ *
+ *  Included by COMEX_Proj.h, don't include it directly.
+ */
+
+#ifndef COMEX_CONFIG_H_
+#define COMEX_CONFIG_H_
+
+
+#define COMEX_CONFIG_FULL 0   /* Everything, as developed */
+#define COMEX_CONFIG_LEAN 1   /* Float Euler link only, counters only */
+
+#ifndef COMEX_CONFIG
+#define COMEX_CONFIG COMEX_CONFIG_FULL
+#endif
+
+
+/* Choices for the settings below */
+#define CLOCK_PROFILE_ALL     0   /* InitSysCtrl as supplied, every peripheral clocked */
+#define CLOCK_PROFILE_MINIMAL 1   /* f_InitSysCtrl_Minimal, only what the features use */
+
+#define ATT_PREDICT_HOLD      0   /* Newest sample as is */
+#define ATT_PREDICT_LINEAR    1   /* Through the last two samples */
+#define ATT_PREDICT_RATE      2   /* Constant rate, fit to the history */
+
+#define INTEGRITY_NONE        0   /* Trust the link */
+#define INTEGRITY_SUM8        1   /* 8 bit sum of the data buffer */
+
+#define INSTR_COUNTERS        0   /* Event/error counters only */
+#define INSTR_TIMING          1   /* + boot stage times, task timing, predictor scoring */
+#define INSTR_BENCH           2   /* + parser and filter benchmarks at start up */
+
+#define LINK_REQUEST_AUTO     0x00   /* 0xA1 (Q7) or 0xA2 (float) per request, f_LinkRequest */
+
+#define TELEM_CH_STAMPS       0x01   /* Record stamp, sample stamp (IPC counter low words) */
+#define TELEM_CH_RPY          0x02   /* Roll, pitch, yaw (deg, float) of the primary IMU */
+#define TELEM_CH_HEALTH       0x04   /* Primary port, link/RX/pool/executive counters */
+#define TELEM_CH_PROFILE      0x08   /* Executive task times */
+
+#define SCI_PORT_A            0
+#define SCI_PORT_B            1
+#define SCI_PORT_C            2
+#define SCI_PORT_D            3
+#define SCI_NPORTS            4
+
+
+/* IMU links
+** COMEX_IMU_PORTS is a mask, bit n for an IMU on SCI port n.
+** More than one port runs redundant IMUs, the samples of
+** COMEX_IMU_PRIMARY drive the attitude while it is healthy */
+#define COMEX_IMU_PORTS       (1 << SCI_PORT_B)
+#define COMEX_IMU_PRIMARY     SCI_PORT_B
+#define SCI_BAUD              9600    /* See f_sci_init */
+#define LINK_REQUEST          0xA2    /* Request 3 x 32 bit floats (0xA5: and the IMU's sample time,
+                                      ** 0xA6: and a sequence number, for COMEX_USE_ARQ) */
+#define LINK_PRECISION_DEG    0.01f   /* Angle resolution the consumers need, LINK_REQUEST_AUTO */
+#define COMEX_INTEGRITY       INTEGRITY_SUM8
+#define LINK_TIMEOUT_US       50000UL /* A request with no complete answer after this is dropped */
+
+/* Forward error correction on the IMU links (Fec.c)
+** The IMU must be set to send Hamming(8,4) coded bytes as well.
+** Corrects one bit error per nibble, at twice the characters */
+#define COMEX_USE_FEC         0
+
+/* Selective retransmission (Link_Arq.c)
+** Needs sequence numbered packets (type 6, LINK_REQUEST 0xA6) and
+** an IMU which keeps its last ARQ_WINDOW packets to resend. A gap
+** in the sequence is NAKed and the packets behind it held back,
+** up to ARQ_HOLD_US, so samples still go out in order.
+** ARQ_WINDOW is a power of 2, and the held packets need their
+** own blocks: PKT_POOL_DEPTH above RX_FRAME_DEPTH + ARQ_WINDOW.
+** Each gap is NAKed up to ARQ_MAX_NAKS times and given up after
+** ARQ_HOLD_US, which bounds the latency ARQ adds to the packets
+** behind it */
+#define COMEX_USE_ARQ         0
+#define ARQ_WINDOW            4
+#define ARQ_MAX_NAKS          2
+#define ARQ_HOLD_US           50000UL
+#define ARQ_CHECK_SLOT_US     2000UL    /* Request interval simulated by f_Arq_Check */
+#define ARQ_CHECK_NLOSS       3
+#define ARQ_CHECK_LOSS        { 10000, 50000, 100000 }  /* Packet loss, ppm */
+
+/* Raw IMU traffic to a host (f_SciRxService)
+** Every byte received from COMEX_BRIDGE_FROM is copied to the TX
+** FIFO of COMEX_BRIDGE_PORT from the RX interrupt, as it arrives,
+** for logging on a PC. COMEX_BRIDGE_BAUD must keep up with the IMU */
+#define COMEX_USE_BRIDGE      0
+#define COMEX_BRIDGE_FROM     COMEX_IMU_PRIMARY
+#define COMEX_BRIDGE_PORT     SCI_PORT_A
+#define COMEX_BRIDGE_BAUD     SCI_BAUD
+
+/* Telemetry on a port of its own (Telemetry.c)
+** Every TELEM_DECIMATION executive ticks a record of the
+** TELEM_CHANNELS (TELEM_CH_*) is packed, and every
+** TELEM_BATCH records go out as one frame from the TX FIFO
+** interrupt. The frames must fit TELEM_BAUD, Dropped counts the
+** ones which didn't. TELEM_RING_BYTES is a power of 2 */
+#define COMEX_USE_TELEMETRY   0
+#define TELEM_PORT            SCI_PORT_C
+#define TELEM_BAUD            115200
+#define TELEM_CHANNELS        (TELEM_CH_STAMPS | TELEM_CH_RPY | TELEM_CH_HEALTH)
+#define TELEM_DECIMATION      10      /* Ticks per record */
+#define TELEM_BATCH           4       /* Records per frame */
+#define TELEM_RING_BYTES      512
+
+/* Request rate (Poll_Rate.c)
+** 1: the request interval follows the measured round trip, up to
+**    the fastest rate the IMU answers cleanly at, backing off on
+**    errors. 0: next request as soon as the last one is answered.
+** Per link, the interval shrinks by POLL_STEP_US with each clean
+** answer, down to POLL_MARGIN_US over a request and answer's line
+** time plus the IMU's turnaround, and doubles (up to POLL_MAX_US)
+** on a checksum failure, timeout or RX overrun. The answer timeout
+** is the smoothed round trip plus 4 deviations, within
+** POLL_RTO_MIN_US..LINK_TIMEOUT_US */
+#define COMEX_USE_ADAPTIVE_POLL 1
+#define POLL_START_US         20000UL
+#define POLL_MIN_US           1000UL
+#define POLL_MAX_US           100000UL
+#define POLL_STEP_US          100UL
+#define POLL_MARGIN_US        250UL
+#define POLL_RTO_MIN_US       2000UL
+
+/* Requests on the control beat (Pwm_Sync.c)
+** 1: ePWM1 drives the executive tick in place of CPU Timer 0, and
+**    ePWM2, phase locked to it, sends the IMU requests
+**    PWM_SYNC_LEAD_US ahead of each tick, so the answers land just
+**    before the control update. One request per tick at most.
+**    PWM_SYNC_LEAD_US 0 takes the lead from the primary link's
+**    measured round trip (needs COMEX_USE_ADAPTIVE_POLL) */
+#define COMEX_USE_PWM_SYNC    0
+#define PWM_SYNC_LEAD_US      0UL
+#define PWM_SYNC_LEAD_MIN_US  50UL    /* Closest lead to either tick edge */
+
+/* IMU link placement
+** 0: CPU1 owns the IMU port and polls the IMU (legacy single core build)
+** 1: CPU2 owns the IMU port, handshake and parsing. CPU1 only consumes
+**    decoded samples from IPC message RAM (build CPU2_RAM as well):
+**    the newest from the snapshot, and every one through the
+**    mailbox into its log of the last IPC_LOG_DEPTH samples */
+#define COMEX_IMU_ON_CPU2     0
+#define IPC_MBX_FLUSH_US      20000UL /* Longest a record waits for a full mailbox batch */
+#define IPC_LOG_DEPTH         16      /* Samples CPU1 keeps of the stream, a power of 2 */
+
+/* Auto-baud handshake (f_Handshake) before the link starts */
+#define COMEX_USE_HANDSHAKE   0
+
+/* Attitude post-processing (Attitude_Post.c, Attitude_Cla.cla)
+** The angles of the RPY packets are scaled, rotated by the IMU
+** mounting, unwrapped and low pass filtered, per link, and the
+** result is the sample everything else gets.
+** COMEX_USE_CLA_POST 1 runs this on the CLA, 0 runs the same math
+** on the C28x (f_AttPost_Reference), in the link's time.
+** COMEX_CLA_CHECK runs the C28x reference alongside the CLA task
+** and counts results which differ by more than CLA_CHECK_TOL */
+#define COMEX_USE_CLA_POST    1
+#define COMEX_CLA_CHECK       0
+#define ATT_MOUNT_YAW         0.0f    /* IMU mounting yaw (deg) */
+#define ATT_POST_ALPHA        0.5f    /* Low pass coefficient, 1 = off */
+
+/* IMU to local clock alignment (Time_Sync.c)
+** Needs the IMU's sample times, packet type 5 (LINK_REQUEST 0xA5).
+** Without them samples keep their arrival stamps.
+** TIME_SYNC_DELAY_US is the IMU's sample to first byte delay,
+** which the arrival stamps can't tell apart from clock offset.
+** Measure it once (scope on the IMU's sample strobe and TX) */
+#define COMEX_USE_TIME_SYNC   1
+#define TIME_SYNC_SPACING_US  500000UL  /* IMU time averaged into one window pair */
+#define TIME_SYNC_MIN_PAIRS   4         /* Before the fit is used */
+#define TIME_SYNC_OUTLIER_US  2000.0f   /* Pairs this far off the fit are skipped */
+#define TIME_SYNC_MAX_REJECTS 4         /* In a row, then the window restarts */
+#define TIME_SYNC_DELAY_US    0UL
+#define TIME_SYNC_CHECK_PPM   100UL     /* f_TimeSync_Check: injected skew */
+#define TIME_SYNC_CHECK_JITTER_US 200UL /* and arrival jitter, up to this */
+
+/* Attitude fusion filter (Attitude_Filter.c) */
+#define COMEX_USE_ATT_FILTER  1
+#define ATT_FILTER_KP         5.0f    /* 1/s */
+#define ATT_FILTER_KI         4.0f    /* 1/s^2 */
+
+/* Latency compensating predictor (Attitude_Predict.c) */
+#define COMEX_USE_ATT_PREDICT 1
+#define ATT_PREDICT_MODE      ATT_PREDICT_RATE
+#define ATT_PREDICT_MAX_US    200000UL  /* Longest extrapolation */
+
+#define COMEX_CLOCK_PROFILE   CLOCK_PROFILE_MINIMAL
+
+/* Watchdog supervision (Supervisor.c) is COMEX_USE_SUPERVISOR,
+** per preset below. It is off in FULL, where the watchdog would
+** bite at every breakpoint */
+
+/* Run the blocking 1000 packet test before starting the executive */
+#define COMEX_TEST_PACKET     0
+
+
+#if COMEX_CONFIG == COMEX_CONFIG_LEAN
+
+/* Packet types the decoder understands, the rest are ignored */
+#define COMEX_PKT_EULER_Q7    0   /* Type 1,  3 x Q7 */
+#define COMEX_PKT_EULER_F32   1   /* Type 2,  3 x float */
+#define COMEX_PKT_EULER_F32_TS 0  /* Type 5,  3 x float + IMU sample time */
+#define COMEX_PKT_EULER_F32_SEQ 0 /* Type 6,  3 x float + sequence number */
+#define COMEX_PKT_QUAT_Q14    0   /* Type 3,  4 x Q14 */
+#define COMEX_PKT_QUAT_F32    0   /* Type 4,  4 x float */
+#define COMEX_PKT_DEBUG       0   /* Types 11 and 12 */
+
+/* Unpackers no packet type uses (f_UnpackFloat_s16/u16, f_UnpackInt_s16) */
+#define COMEX_USE_GENERIC_UNPACK 0
+
+/* Longest packet data buffer (bytes). Sizes the RX frames */
+#define RX_BUFFER_MAX         12
+
+/* Buffer depths, all powers of 2 */
+#define RX_FRAME_DEPTH        2    /* Completed frames queued */
+#define PKT_POOL_DEPTH        4    /* Packet blocks */
+#define IPC_MBX_DEPTH         16   /* Mailbox records */
+#define IPC_MBX_BATCH         4    /* Records per commit/flag */
+#define ATT_PREDICT_DEPTH     4    /* Predictor history */
+#define TIME_SYNC_DEPTH       8    /* Window pairs in the clock fit */
+#define EXEC_MAX_TASKS        4
+
+#define COMEX_INSTRUMENT      INSTR_COUNTERS
+#define COMEX_USE_SUPERVISOR  1
+
+#else /* COMEX_CONFIG_FULL */
+
+#define COMEX_PKT_EULER_Q7    1
+#define COMEX_PKT_EULER_F32   1
+#define COMEX_PKT_EULER_F32_TS 1
+#define COMEX_PKT_EULER_F32_SEQ 1
+#define COMEX_PKT_QUAT_Q14    1
+#define COMEX_PKT_QUAT_F32    1
+#define COMEX_PKT_DEBUG       1
+
+#define COMEX_USE_GENERIC_UNPACK 1
+
+#define RX_BUFFER_MAX         50
+
+#define RX_FRAME_DEPTH        4
+#define PKT_POOL_DEPTH        8
+#define IPC_MBX_DEPTH         16   /* A record is under 48 words, the message RAM 1024 */
+#define IPC_MBX_BATCH         4
+#define ATT_PREDICT_DEPTH     4
+#define TIME_SYNC_DEPTH       16
+#define EXEC_MAX_TASKS        8
+
+#define COMEX_INSTRUMENT      INSTR_BENCH
+#define COMEX_USE_SUPERVISOR  0
+
+#endif
+
+
+/* Host builds (tools/host) #undef and redefine settings here,
+** ahead of the checks below */
+#ifdef COMEX_CONFIG_LOCAL
+#include COMEX_CONFIG_LOCAL
+#endif
+
+
+/* Catch combinations that can't work */
+#if (LINK_REQUEST == 0xA2) && !COMEX_PKT_EULER_F32
+#error "LINK_REQUEST asks for packet type 2 but COMEX_PKT_EULER_F32 is off"
+#endif
+#if (LINK_REQUEST == LINK_REQUEST_AUTO) && !(COMEX_PKT_EULER_Q7 && COMEX_PKT_EULER_F32)
+#error "LINK_REQUEST_AUTO needs packet types 1 and 2 (COMEX_PKT_EULER_Q7, COMEX_PKT_EULER_F32)"
+#endif
+#if (LINK_REQUEST == 0xA5) && !COMEX_PKT_EULER_F32_TS
+#error "LINK_REQUEST asks for packet type 5 but COMEX_PKT_EULER_F32_TS is off"
+#endif
+#if (LINK_REQUEST == 0xA6) && !COMEX_PKT_EULER_F32_SEQ
+#error "LINK_REQUEST asks for packet type 6 but COMEX_PKT_EULER_F32_SEQ is off"
+#endif
+#if COMEX_PKT_EULER_F32_SEQ && (RX_BUFFER_MAX < 14)
+#error "Packet type 6 needs a 14 byte RX_BUFFER_MAX"
+#endif
+#if COMEX_USE_ARQ && !COMEX_PKT_EULER_F32_SEQ
+#error "COMEX_USE_ARQ needs the sequence numbered packets (COMEX_PKT_EULER_F32_SEQ)"
+#endif
+#if COMEX_USE_ARQ && COMEX_IMU_ON_CPU2
+#error "The CPU2 link loop has no ARQ, COMEX_USE_ARQ runs in f_LinkStep"
+#endif
+#if COMEX_USE_ARQ && (PKT_POOL_DEPTH <= RX_FRAME_DEPTH + ARQ_WINDOW)
+#error "PKT_POOL_DEPTH must cover the frames queued, the ARQ_WINDOW held back and the frame being received"
+#endif
+#if COMEX_PKT_EULER_F32_TS && (RX_BUFFER_MAX < 16)
+#error "Packet type 5 needs a 16 byte RX_BUFFER_MAX"
+#endif
+#if COMEX_TEST_PACKET && !COMEX_PKT_DEBUG
+#error "COMEX_TEST_PACKET needs the debug packet types (COMEX_PKT_DEBUG)"
+#endif
+#if PKT_POOL_DEPTH <= RX_FRAME_DEPTH
+#error "PKT_POOL_DEPTH must leave a block for the frame being received"
+#endif
+#if (COMEX_IMU_PORTS & (1 << COMEX_IMU_PRIMARY)) == 0
+#error "COMEX_IMU_PRIMARY is not one of COMEX_IMU_PORTS"
+#endif
+#if COMEX_IMU_ON_CPU2 && (COMEX_IMU_PORTS != (1 << COMEX_IMU_PRIMARY))
+#error "The CPU2 link loop runs a single IMU port"
+#endif
+#if COMEX_CLA_CHECK && !COMEX_USE_CLA_POST
+#error "COMEX_CLA_CHECK checks the CLA task, it needs COMEX_USE_CLA_POST"
+#endif
+#if COMEX_USE_BRIDGE && (COMEX_IMU_PORTS & (1 << COMEX_BRIDGE_PORT))
+#error "COMEX_BRIDGE_PORT is an IMU port"
+#endif
+#if COMEX_USE_BRIDGE && ((COMEX_IMU_PORTS & (1 << COMEX_BRIDGE_FROM)) == 0)
+#error "COMEX_BRIDGE_FROM is not one of COMEX_IMU_PORTS"
+#endif
+#if COMEX_USE_TELEMETRY && ((COMEX_IMU_PORTS & (1 << TELEM_PORT)) || (COMEX_USE_BRIDGE && (TELEM_PORT == COMEX_BRIDGE_PORT)))
+#error "TELEM_PORT is already an IMU or bridge port"
+#endif
+#if COMEX_USE_SUPERVISOR && COMEX_IMU_ON_CPU2
+#error "The supervisor runs off the CPU1 executive, which the CPU2 link build doesn't start"
+#endif
+#if COMEX_USE_TELEMETRY && COMEX_IMU_ON_CPU2
+#error "Telemetry runs off the CPU1 executive, which the CPU2 link build doesn't start"
+#endif
+#if COMEX_USE_TELEMETRY && (TELEM_CHANNELS & TELEM_CH_PROFILE) && (COMEX_INSTRUMENT < INSTR_TIMING)
+#error "The profile telemetry channel needs COMEX_INSTRUMENT >= INSTR_TIMING"
+#endif
+#if COMEX_USE_PWM_SYNC && COMEX_IMU_ON_CPU2
+#error "The CPU2 link loop paces its own requests, COMEX_USE_PWM_SYNC runs in f_LinkStep"
+#endif
+#if COMEX_USE_PWM_SYNC && (PWM_SYNC_LEAD_US == 0) && !COMEX_USE_ADAPTIVE_POLL
+#error "PWM_SYNC_LEAD_US 0 needs the measured round trip (COMEX_USE_ADAPTIVE_POLL)"
+#endif
+#if COMEX_USE_BRIDGE && (COMEX_BRIDGE_BAUD < SCI_BAUD)
+#error "COMEX_BRIDGE_BAUD is slower than the IMU, the bridge would drop bytes"
+#endif
+
+#endif /* COMEX_CONFIG_H_ */
@@ -12,7 +12,10 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "F28x_Project.h"
+#include "COMEX_Config.h"
+#include "COMEX_Cla.h"
 
 
 #define TRUE  1
@@ -21,13 +24,216 @@
 /* n bytes in float */
 #define SFLOAT 2
 
+/* SYSCLK (10 MHz XTAL, IMULT_20, /2). The IPC counter (ReadIpcTimer)
+** runs at SYSCLK, so its ticks are CPU cycles */
+#define COMEX_SYSCLK_MHZ 100
+#define IPC_TICKS_PER_US COMEX_SYSCLK_MHZ
+
+/* LSPCLK (SYSCLK/4 after reset), clocks the SCI baud generators */
+#define COMEX_LSPCLK_HZ (COMEX_SYSCLK_MHZ*1000000UL/4)
+
+/* One SCI character (start + 8 data + stop) in IPC counter ticks */
+#define SCI_BYTE_TICKS(Baud) ((10UL*COMEX_SYSCLK_MHZ*1000000UL)/(Baud))
+
+/* SCI ports the link CPU owns (IMUs and the bridge) and every
+** SCI port the build uses, bit n for SCI port n */
+#if COMEX_USE_BRIDGE
+#define COMEX_LINK_PORTS (COMEX_IMU_PORTS | (1 << COMEX_BRIDGE_PORT))
+#else
+#define COMEX_LINK_PORTS (COMEX_IMU_PORTS)
+#endif
+#if COMEX_USE_TELEMETRY
+#define COMEX_SCI_PORTS (COMEX_LINK_PORTS | (1 << TELEM_PORT))
+#else
+#define COMEX_SCI_PORTS (COMEX_LINK_PORTS)
+#endif
+
+/* g_Links is indexed by SCI port, so it only needs to reach the
+** highest IMU port */
+#if COMEX_IMU_PORTS & (1 << SCI_PORT_D)
+#define LINK_NPORTS 4
+#elif COMEX_IMU_PORTS & (1 << SCI_PORT_C)
+#define LINK_NPORTS 3
+#elif COMEX_IMU_PORTS & (1 << SCI_PORT_B)
+#define LINK_NPORTS 2
+#else
+#define LINK_NPORTS 1
+#endif
+
+/* SCI TX/RX FIFO depth (characters) and the TX FIFO level the
+** transmit interrupt refills at */
+#define SCI_FIFO_DEPTH  16
+#define SCI_TX_REFILL   4
+
+/* Telemetry (Telemetry.c)
+** Frame: 0xA5 0x5A, Length (2, big endian, Seq up to the last
+** record), Seq, Channels, nRecords, records, 8 bit sum of
+** Seq..last record. A record holds the TELEM_CH_* channels
+** (COMEX_Config.h) set in Channels, in bit order, multi byte
+** values big endian.
+** tools/telem_decode.py is the host side and must agree */
+#define TELEM_SYNC0        0xA5
+#define TELEM_SYNC1        0x5A
+#define TELEM_HEAD_BYTES   7      /* Sync to nRecords */
+
+#define TELEM_BYTES_STAMPS  8
+#define TELEM_BYTES_RPY     12
+#define TELEM_BYTES_HEALTH  17
+#define TELEM_BYTES_PROFILE (1 + 10*EXEC_MAX_TASKS)
+#define TELEM_RECORD_MAX    (TELEM_BYTES_STAMPS + TELEM_BYTES_RPY + TELEM_BYTES_HEALTH + TELEM_BYTES_PROFILE)
+#define TELEM_FRAME_MAX     (TELEM_HEAD_BYTES + TELEM_BATCH*TELEM_RECORD_MAX + 1)
+
+/* Interrupt driven receive
+** RX_PACKET_MIN/MAX bound the packet length field
+** (type + buffer length + checksum + RX_BUFFER_MAX byte buffer) */
+#define RX_PACKET_MIN   5
+#define RX_PACKET_MAX   (RX_PACKET_MIN + RX_BUFFER_MAX)
+
+#define RX_PHASE_LEN_HI 0
+#define RX_PHASE_LEN_LO 1
+#define RX_PHASE_BODY   2
+
+/* Boot stages, stamped into g_BootTimes. SYSCTRL includes the
+** LS RAM copies (f_MemCfg_Init) */
+#define BOOT_STAGE_SYSCTRL      0
+#define BOOT_STAGE_GPIO         1
+#define BOOT_STAGE_PIE          2
+#define BOOT_STAGE_SCI          3
+#define BOOT_STAGE_HANDSHAKE    4
+#define BOOT_STAGE_FIRST_SAMPLE 5
+#define BOOT_NSTAGES            6
+
+/* LS RAM ownership, applied by f_MemCfg_Init.
+** Must agree with the placement in COMEX_Sections.cmd:
+**   LS1  ComexRxRing, ComexPool, ComexHistory, ComexTrace, ComexRetain
+**   LS2  ComexHotCode
+**   LS3  CLA data (.scratchpad, .bss_cla, .const_cla)
+**   LS4  CLA program (Cla1Prog)
+** LS0 and LS5 belong to the device linker file */
+#define LS_CPU       0
+#define LS_CLA_DATA  1
+#define LS_CLA_PROG  2
+
+#define LS1_OWNER    LS_CPU
+#define LS2_OWNER    LS_CPU
+#define LS3_OWNER    LS_CLA_DATA
+#define LS4_OWNER    LS_CLA_PROG
+
+/* Fast math
+** With --tmu_support=tmu0 these are single TMU instructions,
+** otherwise (host or non-TMU builds) they fall back to libm */
+#if defined(__TMS320C28XX_TMU__)
+#define CMATH_TMU         1
+#define CMATH_SIN(x)      __sin(x)
+#define CMATH_COS(x)      __cos(x)
+#define CMATH_ATAN2(y,x)  __atan2(y,x)
+#define CMATH_SQRT(x)     __sqrt(x)
+#else
+#define CMATH_TMU         0
+#define CMATH_SIN(x)      sinf(x)
+#define CMATH_COS(x)      cosf(x)
+#define CMATH_ATAN2(y,x)  atan2f(y,x)
+#define CMATH_SQRT(x)     sqrtf(x)
+#endif
+
+/* Attitude post-processing (Attitude_Post.c, Attitude_Cla.cla) */
+#define ATT_POST_WAIT_US   10    /* Longest wait for Cla1Task1's result */
+
+/* Attitude fusion filter (Attitude_Filter.c) */
+#define ATT_FILTER_MAX_DT    0.2f   /* s, cap on one correction step */
+
+/* Fixed rate executive (Executive.c)
+** Periods are in executive ticks */
+#define EXEC_TICK_US        1000   /* CPU Timer 0 (or ePWM1) period */
+#define EXEC_PERIOD_LINK    1      /* IMU link service */
+#define EXEC_PERIOD_CONTROL 1      /* CLA result, predicted attitude */
+
+/* Link service: the primary IMU link hands over to another after
+** LINK_STALE_US without a good packet */
+#define LINK_STALE_US       (4*LINK_TIMEOUT_US)
+
+#define LINK_IDLE 0
+#define LINK_WAIT 1
+#define LINK_REQ_MAX 3   /* Bytes in a request (a NAK) */
+
+/* Forward error correction (Fec.c)
+** g_FecLut entries: decoded nibble, and the flags */
+#define FEC_CORRECTED        0x10   /* One bit error, corrected */
+#define FEC_BAD              0x20   /* Two or more, nearest nibble */
+#if COMEX_USE_FEC
+#define FEC_EXPANSION        2      /* Characters on the line per byte */
+#else
+#define FEC_EXPANSION        1
+#endif
+#define FEC_RESYNC_BYTES     4      /* Line idle this long: next character is a high nibble */
+#define FEC_BENCH_BYTES      19     /* Type 2 packet, length to checksum */
+#define FEC_BENCH_NBER       4
+#define FEC_BENCH_BER        { 100, 1000, 3000, 10000 }  /* Bit error rates, ppm */
+
+/* Automatic packet type (LINK_REQUEST_AUTO, f_LinkRequest)
+** Q7 (type 1, 13 bytes on the wire) is asked for instead of float
+** (type 2, 19 bytes) while its resolution meets LINK_PRECISION_DEG,
+** the last angles are LINK_AUTO_MARGIN_DEG inside its range and
+** the 6 bytes saved are at least LINK_AUTO_MIN_GAIN of the round
+** trip. A Q7 answer at the end of its range is taken as clipped
+** and not used */
+#define LINK_Q7_LSB_DEG       (1.0f/128.0f)
+#define LINK_Q7_RANGE_DEG     256.0f
+#define LINK_AUTO_MARGIN_DEG  16.0f
+#define LINK_AUTO_MIN_GAIN    0.10f
+#define LINK_Q7_SAVED_BYTES   6
+
+/* Selective retransmission (Link_Arq.c)
+** A NAK is ARQ_NAK then the missing sequence number, high byte
+** first; the IMU answers with that packet again */
+#define ARQ_NAK              0xAE
+
+/* Requests on the control beat (Pwm_Sync.c)
+** ePWM time bases count EPWMCLK, SYSCLK/2, and must fit a tick in
+** 16 bits. The automatic lead is the smoothed round trip plus
+** PWM_SYNC_GUARD_US for the ISRs and the last byte's framing,
+** clamped to PWM_SYNC_LEAD_MIN_US..EXEC_TICK_US - PWM_SYNC_LEAD_MIN_US */
+#define PWM_SYNC_TBCLK_MHZ    (COMEX_SYSCLK_MHZ/2)
+#define PWM_SYNC_PERIOD       (1UL*PWM_SYNC_TBCLK_MHZ*EXEC_TICK_US)
+#define PWM_SYNC_GUARD_US     100UL
+
+/* Supervisor (Supervisor.c)
+** A link with no good packet for LINK_STALL_US is rebuilt, again
+** every LINK_STALL_US until it answers. Once the primary link has
+** been rebuilt LINK_MAX_REBUILDS times in a row the watchdog is
+** left to reset the device.
+** The watchdog counts INTOSC1/512/prescale and bites at 256:
+** WD_PRESCALE 4 (/8) is 10 MHz/512/8, 256 counts ~105 ms.
+** A rebuild's handshake must fit well inside that */
+#define LINK_STALL_US        (3*LINK_TIMEOUT_US)
+#define LINK_MAX_REBUILDS    5
+#define RECOVER_HANDSHAKE_US 50000UL
+#define WD_PRESCALE          4
+#define EXEC_PERIOD_SUPER    1
+#define RETAIN_MAGIC         0xC0DE5AFEUL
+
+/* Other blocking waits */
+#define TX_TIMEOUT_US        5000UL     /* A few character times */
+#define HANDSHAKE_TIMEOUT_US 2000000UL  /* Whole auto-baud handshake */
+#define IPC_SYNC_TIMEOUT_US  1000000UL  /* One wait for CPU1's port hand-off */
+
+/* Status of calls which can time out */
+#define IO_OK      0
+#define IO_TIMEOUT 1
+
+/* IPC flags used by the CPU2 -> CPU1 sample handoff
+** Flags 0-3 generate PIE interrupts on the remote CPU */
+#define IPC_FLAG_SAMPLE    0   /* New sample in CPU2 -> CPU1 message RAM */
+#define IPC_FLAG_MBX       1   /* New batch in the CPU2 -> CPU1 mailbox */
+#define IPC_FLAG_BOOT_SYNC 31  /* CPU1 has released the IMU port to CPU2 */
+
 
 typedef struct
 {
     uint16_t Packet_nBytes;     /* Length of entire packet, minus this variable, in bytes */
     uint16_t PacketType;        /* Type code of packet */
-    uint16_t Buffer_nBytes;     /* Length of data buffer in bytes (0-50) */
-    unsigned char  Buffer[50];  /* Data buffer */
+    uint16_t Buffer_nBytes;     /* Length of data buffer in bytes (0-RX_BUFFER_MAX) */
+    unsigned char  Buffer[RX_BUFFER_MAX];  /* Data buffer */
     unsigned char  CheckSum;         /* CheckSum of data buffer only */
 } RESPONSE_TYPE;
 
@@ -36,12 +242,64 @@ typedef struct
     bool BaudLock;
 } IMU_STATE_TYPE;
 
+typedef struct
+{
+    Uint16 Runs;
+    Uint16 Flash;           /* Flash build (parser copied to LS RAM) */
+    Uint32 DecodeCycles;    /* f_DecodePacket, type 2 */
+    Uint32 CheckSumCycles;  /* f_CheckSum, 12 bytes */
+} PARSER_BENCH_TYPE;
+
+/* Power up to first sample. Cleared first thing in f_Initialize,
+** so the stamps of stages that never ran stay 0 */
+typedef struct
+{
+    Uint32 Stamp[BOOT_NSTAGES];     /* IPC counter (low word) at the end of each stage */
+    Uint32 Stage_us[BOOT_NSTAGES];  /* Filled in by f_BootReport */
+    Uint32 Total_us;                /* Reset to first sample */
+    Uint16 Profile;                 /* COMEX_CLOCK_PROFILE */
+} BOOT_TIMES_TYPE;
+
+/* Absolute IPC counter time, see f_Deadline_Set */
+typedef Uint64 DEADLINE_TYPE;
+
+/* One packet as framed by the RX ISR */
+typedef struct
+{
+    Uint16         nBytes;                 /* Packet length field */
+    unsigned char  Bytes[RX_PACKET_MAX];   /* Packet, after the length */
+    Uint64         FirstStamp;             /* IPC counter, first length byte */
+    Uint64         LastStamp;              /* IPC counter, checksum byte */
+} RX_FRAME_TYPE;
+
+typedef struct
+{
+    Uint32 Frames;         /* Frames handed to the foreground */
+    Uint16 Overruns;       /* Frames dropped, no queue slot or pool block */
+    Uint16 BadLength;      /* Length field out of range */
+    Uint16 FifoOverflows;  /* SCI RX FIFO overflowed */
+    Uint32 Forwarded;      /* Bytes copied to the bridge port */
+    Uint16 ForwardDrops;   /* Bytes not copied, bridge TX FIFO full */
+    Uint32 FecCorrected;   /* Codewords with one bit error, corrected (COMEX_USE_FEC) */
+    Uint16 FecBad;         /* Codewords with more, not correctable */
+} RX_STATS_TYPE;
+
 
 typedef struct
 {
   float Roll;
   float Pitch;
   float Yaw;
+  float Quat[4];   /* Unit quaternion w, x, y, z (w >= 0) */
+
+  Uint64 RxFirstStamp;  /* IPC counter when the packet started to arrive */
+  Uint64 RxLastStamp;   /* IPC counter when the packet was complete */
+  Uint64 SampleStamp;   /* IPC counter when the IMU took the sample (Time_Sync.c),
+                        ** RxFirstStamp until the IMU clock is aligned */
+  Uint32 ImuStamp_us;   /* IMU's own sample time, packet type 5 */
+  Uint16 HasImuStamp;
+  Uint16 Seq;           /* IMU's packet sequence number, packet type 6 */
+  Uint16 HasSeq;
 
   uint16_t Test_uI16;
   int      Test_sI16;
@@ -49,20 +307,616 @@ typedef struct
 } DATA_TYPE;
 
 
+/* Sample record published by whoever owns the IMU link
+** (the RX path on this core, or the link core via IPC) */
+typedef struct
+{
+    Uint32    Seq;         /* Incremented for every published sample */
+    Uint16    ErrorCount;  /* Checksum failures seen by the link owner */
+    Uint64    Stamp;       /* IPC counter when the sample was published */
+    DATA_TYPE Data;        /* Decoded sample */
+} ATT_SAMPLE_TYPE;
+
+/* Packet pool (Packet_Pool.c)
+** Fixed size blocks, one received frame each. The RX ISR fills
+** them, the link service decodes and frees them, and under
+** COMEX_USE_ARQ holds them in the window until they are in order */
+typedef struct
+{
+    RX_FRAME_TYPE   Frame;    /* Raw packet */
+} PKT_BLOCK_TYPE;
+
+typedef struct
+{
+    Uint16 Allocs;      /* Wrapping counts */
+    Uint16 Frees;
+    Uint16 Empty;       /* Allocs refused, every block in use */
+    Uint16 BadFree;     /* Free of a block not from the pool, or not in use */
+    Uint16 HighWater;   /* Most blocks in use at once */
+} PKT_POOL_STATS_TYPE;
+
+/* Transmit byte ring of a port (f_SciTx_Init). The foreground owns
+** Head, the TX ISR owns Tail, both free running */
+typedef struct
+{
+    unsigned char  *Buf;
+    Uint16          Size;   /* Power of 2 */
+    volatile Uint16 Head;
+    volatile Uint16 Tail;
+} SCI_TX_RING_TYPE;
+
+/* One SCI port (Sci_Port.c): registers, receive queue,
+** framer state and statistics */
+typedef struct SCI_PORT
+{
+    volatile struct SCI_REGS *Regs;
+    Uint16 Id;                 /* SCI_PORT_A..D */
+    Uint32 ByteTicks;          /* One character at the port's baud */
+
+    /* Port every received byte is copied to (the bridge), or 0 */
+    struct SCI_PORT *Forward;
+
+    /* Interrupt driven transmit, or 0 */
+    SCI_TX_RING_TYPE *Tx;
+
+    /* Completed frames, RX ISR -> foreground (single producer/consumer) */
+    PKT_BLOCK_TYPE * volatile Queue[RX_FRAME_DEPTH];
+    volatile Uint16 Head;
+    volatile Uint16 Tail;
+
+    /* Frame being assembled and where the ISR is in it.
+    ** Scratch takes the bytes of a frame which has no queue slot
+    ** or pool block (pBlock is 0 then) */
+    RX_FRAME_TYPE   Scratch;
+    RX_FRAME_TYPE  *pWork;
+    PKT_BLOCK_TYPE *pBlock;
+    Uint16 Phase;
+    Uint16 Count;
+
+    /* FEC: high nibble waiting for its low one (COMEX_USE_FEC) */
+    Uint16 FecHalf;
+    Uint16 FecHi;
+    Uint64 FecLast;        /* Stamp of the last character */
+
+    RX_STATS_TYPE Stats;
+} SCI_PORT_TYPE;
+
+/* Double buffered, sequence counted attitude snapshot
+** Seq is bumped to odd before a buffer is written and back to
+** even once it is complete. Buffer (Seq>>1)&1 is the one being
+** written, the other one always holds the last complete sample.
+** The writer never waits and a reader only has to retry if the
+** writer laps it (two publishes during one read). */
+typedef struct
+{
+    volatile Uint32          Seq;
+    volatile ATT_SAMPLE_TYPE Buf[2];
+} ATT_SNAPSHOT_TYPE;
+
+/* Reader retries before f_Snapshot_Read gives up */
+#define SNAPSHOT_MAX_RETRIES 4
+
+/* IPC mailbox
+** Ring of sample records in the producer's send message RAM.
+** The producer owns Head (in its RAM), the consumer owns Tail
+** (in its RAM), so each index has exactly one writer.
+** Head and Tail are free running, the slot is Index & (DEPTH-1).
+** IPC_FLAG_MBX is raised once per committed batch, a batch being
+** IPC_MBX_BATCH records or whatever is queued once the oldest has
+** waited IPC_MBX_FLUSH_US (all in COMEX_Config.h). Snapshot and
+** mailbox together must fit MSG_RAM_SIZE (checked in Ipc_Link.c) */
+
+/* Layout of each CPU's send message RAM (MSG_RAM_SIZE words) */
+typedef struct
+{
+    ATT_SNAPSHOT_TYPE        Snapshot;             /* Latest sample (producer) */
+    volatile Uint16          MbxHead;              /* Written by the producer */
+    volatile Uint16          MbxTail;              /* Written by the consumer */
+    volatile ATT_SAMPLE_TYPE MbxRec[IPC_MBX_DEPTH];/* Written by the producer */
+} IPC_MSG_RAM_TYPE;
+
+#define IPC_SEND_RAM ((IPC_MSG_RAM_TYPE *)SEND_MSG_RAM)
+#define IPC_RECV_RAM ((IPC_MSG_RAM_TYPE *)RECV_MSG_RAM)
+
+#define IPC_SEND_SNAPSHOT (&IPC_SEND_RAM->Snapshot)
+#define IPC_RECV_SNAPSHOT (&IPC_RECV_RAM->Snapshot)
+
+typedef struct
+{
+    Uint32 Published;  /* Samples written to the snapshot */
+    Uint32 Received;   /* New samples read from the snapshot */
+    Uint32 Missed;     /* Samples overwritten before they were read */
+    Uint32 LastSeq;    /* Seq of the last sample read */
+    Uint16 Retries;    /* Snapshot reads which had to be repeated */
+    Uint16 Failed;     /* Snapshot reads which ran out of retries */
+
+    Uint32 MbxPut;      /* Records queued by the producer */
+    Uint32 MbxGot;      /* Records drained by the consumer */
+    Uint16 MbxFull;     /* Records refused, ring was full */
+    Uint16 MbxBatches;  /* Batches committed (= flags raised) */
+    Uint16 MbxTimed;    /* Of those, committed short by IPC_MBX_FLUSH_US or an idle link */
+    Uint16 SyncTimeouts; /* Waits for CPU1's port hand-off which timed out (CPU2) */
+
+    Uint32 LogSeq;      /* Seq of the last record logged (consumer) */
+    Uint16 LogGaps;     /* Records missing from the stream */
+    Uint32 LogAgeMax_us; /* Longest publish to log */
+} IPC_LINK_STATS_TYPE;
+
+/* Consumer's log of the mailbox stream: the last IPC_LOG_DEPTH
+** samples, in order, for the debugger or a post mortem dump */
+typedef struct
+{
+    Uint16          Head;                 /* Next slot, free running */
+    ATT_SAMPLE_TYPE Rec[IPC_LOG_DEPTH];
+} IPC_LOG_TYPE;
+
+
+typedef struct
+{
+    Uint32 Started;    /* Packets handed to the CLA (COMEX_USE_CLA_POST) */
+    Uint32 Completed;  /* Results collected */
+    Uint16 Busy;       /* Packets skipped, CLA still running */
+    Uint16 Late;       /* Packets dropped, no result in ATT_POST_WAIT_US */
+    Uint16 Mismatch;   /* CLA vs reference beyond CLA_CHECK_TOL */
+} ATT_POST_STATS_TYPE;
+
+
+/* Complementary filter state (angles and rates in rad, rad/s) */
+typedef struct
+{
+    float  Angle[3];     /* Roll, pitch, yaw estimate at Stamp */
+    float  Rate[3];      /* Learned angular rates */
+    float  Kp;
+    float  Ki;
+    Uint64 Stamp;        /* IPC counter of the estimate */
+    Uint64 LastMeas;     /* IPC counter of the last sample */
+    Uint16 Valid;
+    Uint32 Corrections;
+} ATT_FILTER_TYPE;
+
+typedef struct
+{
+    Uint16 Packets;                         /* Per bit error rate */
+    Uint32 DecodeCycles;                    /* One coded packet through g_FecLut */
+    Uint16 BerPpm[FEC_BENCH_NBER];
+    Uint16 PlainGood[FEC_BENCH_NBER];       /* Packets through intact, uncoded */
+    Uint16 FecGood[FEC_BENCH_NBER];         /* Coded */
+    Uint32 Corrected[FEC_BENCH_NBER];       /* Bytes with a corrected codeword */
+    float  PlainGoodput[FEC_BENCH_NBER];    /* Packets per character time, clean plain = 1 */
+    float  FecGoodput[FEC_BENCH_NBER];
+} FEC_BENCH_TYPE;
+
+typedef struct
+{
+    Uint16 Updates;
+    Uint16 Tmu;              /* Build used the TMU */
+    Uint32 CyclesPerUpdate;  /* Correct + estimate */
+} ATT_FILTER_BENCH_TYPE;
+
+
+typedef struct
+{
+    Uint16 Clamped;    /* Queries beyond ATT_PREDICT_MAX_US */
+    Uint16 Restarts;   /* History dropped, stamps out of order */
+} ATT_PREDICT_STATS_TYPE;
+
+/* Sample history, angles (deg) unwrapped per axis */
+typedef struct
+{
+    Uint16 Mode;
+    Uint16 Head;                             /* Next slot to write */
+    Uint16 Count;                            /* Valid samples */
+    float  Angle[ATT_PREDICT_DEPTH][3];
+    Uint64 Stamp[ATT_PREDICT_DEPTH];         /* IPC counter */
+    ATT_PREDICT_STATS_TYPE Stats;
+} ATT_PREDICT_TYPE;
+
+typedef struct
+{
+    Uint16 Samples;
+    Uint32 Lead_us;     /* Query time past each sample */
+    float  ErrMean[3];  /* Mean |error| (deg), roll, pitch, yaw */
+    float  ErrMax[3];   /* Worst |error| (deg) */
+} ATT_PREDICT_CHECK_TYPE;
+
+
+typedef void (*EXEC_FN_TYPE)( void );
+
+/* Executive task, times in IPC counter cycles */
+typedef struct
+{
+    EXEC_FN_TYPE Fn;
+    Uint16 Period;      /* Ticks */
+    Uint32 Next;        /* Tick of the next release */
+    Uint32 Runs;
+    Uint32 Overruns;    /* Still running at the next release */
+    Uint32 ExecLast;
+    Uint32 ExecMin;
+    Uint32 ExecMax;
+    Uint64 ExecSum;     /* ExecSum/Runs is the mean */
+    Uint32 LatencyMax;  /* Worst tick to start of task */
+} EXEC_TASK_TYPE;
+
+typedef struct
+{
+    Uint16 nTasks;
+    Uint32 Ticks;          /* Ticks dispatched */
+    Uint32 MissedTicks;    /* Ticks that passed without a dispatch */
+    Uint32 FrameOverruns;  /* Tasks of one tick ran into the next */
+} EXEC_STATS_TYPE;
+
+typedef struct
+{
+    Uint32 Requests;
+    Uint32 Good;
+    Uint16 BadChecksum;
+    Uint16 Timeouts;
+    Uint16 Failovers;   /* Times this link lost the primary role */
+    Uint16 Rebuilds;    /* SCI rebuilt after a stall (Supervisor.c) */
+    Uint32 Compact;     /* Q7 requests, LINK_REQUEST_AUTO */
+    Uint16 Clipped;     /* Q7 answers at the end of the range, not used */
+} LINK_STATS_TYPE;
+
+/* IMU to local clock fit (Time_Sync.c), per link.
+** Over the last TIME_SYNC_DEPTH window pairs, each the mean
+** (IMU time, arrival) of TIME_SYNC_SPACING_US worth of samples:
+**   Local - RefLocal = Offset + Rate * (Imu - RefImu)   (us)
+** with the newest window pair as reference */
+typedef struct
+{
+    Uint32 Pairs;        /* Sample pairs offered */
+    Uint16 Rejected;     /* Pairs beyond TIME_SYNC_OUTLIER_US of the fit */
+    Uint16 Duplicates;   /* Pairs skipped, same IMU time as the last */
+    Uint16 Restarts;     /* Window dropped: IMU clock went back, or rejects */
+    float  SkewPpm;      /* (Rate - 1) * 1e6, + : our clock runs fast */
+    float  ResidRms_us;  /* Residual of the last fit */
+    float  ResidMax_us;
+} TIME_SYNC_STATS_TYPE;
+
+typedef struct
+{
+    Uint16 Head;                          /* Next slot to write */
+    Uint16 Count;                         /* Pairs in the window */
+    Uint64 Imu[TIME_SYNC_DEPTH];          /* IMU time, us, unwrapped */
+    Uint64 Local[TIME_SYNC_DEPTH];        /* Arrival, IPC counter */
+    Uint32 LastRaw;                       /* Last IMU stamp, for unwrapping */
+    Uint32 Wraps;
+    Uint64 AccImu0;                       /* Window pair being averaged: */
+    Uint64 AccLocal0;                     /*   first sample pair */
+    Uint32 AccImu;                        /*   sums relative to it (us) */
+    Uint64 AccLocal;                      /*   (IPC counter ticks) */
+    Uint16 AccN;
+    Uint16 Rejects;                       /* In a row */
+    Uint16 Valid;                         /* Fit in use */
+    Uint64 RefImu;
+    Uint64 RefLocal;
+    float  Offset_us;
+    float  Rate;
+    TIME_SYNC_STATS_TYPE Stats;
+} TIME_SYNC_TYPE;
+
+typedef struct
+{
+    Uint16 Pairs;
+    float  SkewPpm;      /* Injected */
+    float  SkewErrPpm;   /* Estimated - injected */
+    float  MaxErr_us;    /* Worst mapped stamp error once locked */
+    float  ResidRms_us;  /* Of the last fit */
+    Uint16 Restarts;
+    Uint32 CyclesPerPair;
+} TIME_SYNC_CHECK_TYPE;
+
+typedef struct
+{
+    Uint32 Records;    /* Records packed */
+    Uint32 Frames;     /* Frames queued for transmission */
+    Uint16 Dropped;    /* Frames not queued, TX ring full */
+    Uint16 Seq;        /* Sequence number of the next frame */
+} TELEM_STATS_TYPE;
+
+typedef struct
+{
+    Uint32 Delivered;    /* In order, to the consumers */
+    Uint16 Recovered;    /* Of those, resent after a NAK */
+    Uint16 Lost;         /* Gaps given up on */
+    Uint16 Naks;
+    Uint16 Duplicates;   /* Already held, or already given up on */
+    Uint32 AddedMax_us;  /* Arrival (or due time, if resent) to delivery */
+    Uint32 AddedSum_us;
+} ARQ_STATS_TYPE;
+
+/* Reorder window of one link, by sequence number: Expect is the
+** next to deliver, Next one past the newest seen. Slot holds the
+** frame of a packet in, 0 for a gap */
+typedef struct
+{
+    PKT_BLOCK_TYPE *Slot[ARQ_WINDOW];
+    Uint64 Stamp[ARQ_WINDOW];    /* Arrival, or for a gap when it was due */
+    Uint64 Missed[ARQ_WINDOW];   /* When the gap was seen */
+    Uint16 Naks[ARQ_WINDOW];
+    Uint16 Expect;
+    Uint16 Next;
+    Uint16 Started;
+    Uint64 LastStamp;            /* Arrival of Next-1 */
+    ARQ_STATS_TYPE Stats;
+} ARQ_TYPE;
+
+typedef struct
+{
+    Uint16 Packets;                      /* Per loss rate */
+    Uint32 LossPpm[ARQ_CHECK_NLOSS];
+    float  PlainGoodput[ARQ_CHECK_NLOSS];  /* Samples delivered / sent, no ARQ */
+    float  ArqGoodput[ARQ_CHECK_NLOSS];
+    Uint16 Lost[ARQ_CHECK_NLOSS];
+    Uint16 Naks[ARQ_CHECK_NLOSS];
+    float  AddedMean_us[ARQ_CHECK_NLOSS];
+    Uint32 AddedMax_us[ARQ_CHECK_NLOSS];
+} ARQ_CHECK_TYPE;
+
+typedef struct
+{
+    Uint32 Requests;     /* Sent from the ePWM2 ISR */
+    Uint32 Skipped;      /* Triggers with a link still waiting, or not armed */
+    Uint32 Lead_us;      /* Trigger to tick, now */
+    Uint32 Fresh;        /* Control updates with a sample new since the last */
+    Uint32 AgeLast_us;   /* Primary sample's last byte in to the control update */
+    Uint32 AgeMax_us;    /* Of the fresh ones */
+    Uint32 AgeSum_us;
+} PWM_SYNC_STATS_TYPE;
+
+/* Kept across resets in ComexRetain (NOINIT), valid while Magic
+** is RETAIN_MAGIC. Cleared on a power on reset */
+typedef struct
+{
+    Uint32 Magic;
+    Uint16 Boots;            /* Resets since power on */
+    Uint16 WatchdogResets;
+    Uint32 LastCause;        /* CpuSysRegs.RESC at the last boot */
+    Uint16 Rebuilds;         /* Link rebuilds, every boot */
+    Uint16 Recoveries;       /* Stalled links which came back */
+    Uint32 OutageLast_us;    /* Last good packet to first good one after a stall */
+    Uint32 OutageMax_us;
+} RETAIN_TYPE;
+
+typedef struct
+{
+    Uint32 Serviced;    /* Healthy cycles, watchdog serviced */
+    Uint32 Unhealthy;   /* Cycles the watchdog was left alone */
+} SUPER_STATS_TYPE;
+
+typedef struct
+{
+    Uint32 Samples;      /* Round trips measured */
+    Uint16 Skipped;      /* Answers after a timeout, not measured */
+    Uint16 Backoffs;     /* Interval doubled */
+    Uint32 RttMax_us;
+    Uint32 IntervalMin_us;
+} POLL_STATS_TYPE;
+
+/* Request pacing of one link. Round trip is request sent to the
+** last byte of the answer in; turnaround is the part of it the
+** IMU spends before answering (round trip less the request and
+** answer on the wire) */
+typedef struct
+{
+    Uint32 Interval_us;  /* Request to request */
+    Uint32 Srtt_us;      /* Smoothed round trip (1/8) */
+    Uint32 RttVar_us;    /* Its mean deviation (1/4) */
+    Uint32 Turn_us;      /* Smoothed IMU turnaround (1/8) */
+    Uint32 Line_us;      /* Request and answer on the wire, last answer */
+    Uint32 Rto_us;       /* Answer timeout */
+    Uint64 Sent;         /* IPC counter, last request */
+    Uint16 Retry;        /* Last request followed a timeout */
+    Uint16 PortErrors;   /* Port overruns + FIFO overflows, last seen */
+    POLL_STATS_TYPE Stats;
+} POLL_RATE_TYPE;
+
+/* One IMU request/response link, on its own SCI port */
+typedef struct
+{
+    SCI_PORT_TYPE *Port;
+    Uint16 State;            /* LINK_IDLE, LINK_WAIT */
+    DEADLINE_TYPE Deadline;  /* For the answer to the last request */
+    Uint16 Errors;           /* Checksum failures */
+    Uint64 LastGood;         /* IPC counter, last good packet (0: none yet) */
+    DATA_TYPE Sample;        /* Last good sample */
+    Uint16 Clipped;          /* Last answer was a clipped Q7, ask for floats */
+    Uint16 Rebuilds;         /* In a row, since the last good packet */
+    Uint64 RebuildStamp;     /* IPC counter, last rebuild (or supervisor start) */
+    Uint64 StallStart;       /* Last good packet before the current stall */
+    TIME_SYNC_TYPE Sync;     /* This IMU's clock against ours */
+    POLL_RATE_TYPE Poll;     /* Request pacing */
+    CLA_ATT_STATE_TYPE Post; /* Attitude post-processing (Attitude_Post.c) */
+#if COMEX_USE_ARQ
+    ARQ_TYPE Arq;            /* Reorder window, retransmission */
+#endif
+#if COMEX_USE_PWM_SYNC
+    volatile Uint16 SyncArmed;   /* SyncReq ready for the ePWM2 ISR to send */
+    volatile Uint16 SyncSent;    /* Requests the ISR sent, it counts */
+    Uint16 SyncSeen;             /* SyncSent the link has moved on for */
+    Uint16 SyncLen;
+    unsigned char SyncReq[LINK_REQ_MAX];
+    volatile Uint64 SyncStamp;   /* IPC counter, ISR sent the last */
+#endif
+    LINK_STATS_TYPE Stats;
+} LINK_TYPE;
+
+
 void f_Initialize( void );
-void f_fifo_init(void);
-void f_sci_init(void);
-void f_Handshake(  IMU_STATE_TYPE g_IMU_state  );
+void f_ImuPorts_Open( void );
+void f_Link_Init( void );
+void f_Link_Rebuild( LINK_TYPE *Link );
+void f_MemCfg_Init( void );
+void f_InitSysCtrl_Minimal( void );
+void f_InitPeripheralClocks_Minimal( void );
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+void f_BootStage( Uint16 Stage );
+void f_BootReport( void );
+#else
+#define f_BootStage( Stage )
+#define f_BootReport()
+#endif
+Uint16 f_Handshake( SCI_PORT_TYPE *Port, IMU_STATE_TYPE g_IMU_state, Uint32 Timeout_us );
+
+DEADLINE_TYPE f_Deadline_Set( Uint32 Timeout_us );
+bool f_Deadline_Expired( DEADLINE_TYPE Deadline );
 
-void f_xmit_char( char xmitChar );
-void f_rcv_char( char *InputBuffer );
-void f_GetPacket( DATA_TYPE *Data, RESPONSE_TYPE *Response );
+void f_SciPort_Init( void );
+void f_SciPort_Pins( SCI_PORT_TYPE *Port, Uint16 Cpu );
+void f_SciPort_Bridge( SCI_PORT_TYPE *From, SCI_PORT_TYPE *To );
+void f_fifo_init( SCI_PORT_TYPE *Port );
+void f_sci_init( SCI_PORT_TYPE *Port, Uint32 Baud );
+void f_rx_isr_init( SCI_PORT_TYPE *Port );
+Uint16 f_WaitTxEmpty( SCI_PORT_TYPE *Port, DEADLINE_TYPE Deadline );
+Uint16 f_WaitRxFifo( SCI_PORT_TYPE *Port, DEADLINE_TYPE Deadline );
+void f_xmit_char( SCI_PORT_TYPE *Port, char xmitChar );
+void f_rcv_char( SCI_PORT_TYPE *Port, char *InputBuffer );
+void f_SciPort_Stop( SCI_PORT_TYPE *Port );
+void f_RxReset( SCI_PORT_TYPE *Port );
+bool f_RxFrameGet( SCI_PORT_TYPE *Port, RX_FRAME_TYPE *Frame );
+PKT_BLOCK_TYPE *f_RxFrameTake( SCI_PORT_TYPE *Port );
+void f_SciRxService( SCI_PORT_TYPE *Port );
+__interrupt void f_SciaRxIsr( void );
+__interrupt void f_ScibRxIsr( void );
+__interrupt void f_ScicRxIsr( void );
+__interrupt void f_ScidRxIsr( void );
+void f_SciTx_Init( SCI_PORT_TYPE *Port, SCI_TX_RING_TYPE *Ring, unsigned char *Buf, Uint16 Size );
+bool f_SciTx_Write( SCI_PORT_TYPE *Port, unsigned char *Bytes, Uint16 n );
+void f_SciTxService( SCI_PORT_TYPE *Port );
+__interrupt void f_SciaTxIsr( void );
+__interrupt void f_ScibTxIsr( void );
+__interrupt void f_ScicTxIsr( void );
+__interrupt void f_ScidTxIsr( void );
+
+void f_Telem_Init( void );
+void f_Telem_Task( void );
+
+Uint16 f_GetPacket( SCI_PORT_TYPE *Port, DATA_TYPE *Data, RESPONSE_TYPE *Response, Uint32 Timeout_us );
+void f_DecodePacket( RX_FRAME_TYPE *Frame, DATA_TYPE *Data, RESPONSE_TYPE *Response );
+Uint32 f_SampleAge_us( DATA_TYPE *Data );
+void f_Parser_Benchmark( Uint16 nRuns );
 void f_UnpackFloat_s16( unsigned char *Packet, float *Output );
 void f_UnpackFloat_u16( unsigned char *Packet, float *Output );
+void f_UnpackFloat_q14( unsigned char *Packet, float *Output );
 void f_UnpackFloat_s32( unsigned char *Packet, float *Output );
 void f_UnpackInt_u16( unsigned char *Packet, unsigned int *Output );
+void f_UnpackInt_u32( unsigned char *Packet, Uint32 *Output );
 void f_UnpackInt_s16( unsigned char *Packet, int *Output );
 unsigned char f_CheckSum( unsigned char *p_Buffer, uint16_t nBytes );
+bool f_PacketOk( RESPONSE_TYPE *Response );
+
+void f_QuatNormalize( float *Quat );
+void f_EulerToQuat( float Roll, float Pitch, float Yaw, float *Quat );
+void f_QuatToEuler( float *Quat, float *Roll, float *Pitch, float *Yaw );
+
+void f_Snapshot_Init( ATT_SNAPSHOT_TYPE *Snap );
+void f_Snapshot_Publish( ATT_SNAPSHOT_TYPE *Snap, DATA_TYPE *Data, Uint16 ErrorCount );
+Uint16 f_Snapshot_Read( ATT_SNAPSHOT_TYPE *Snap, ATT_SAMPLE_TYPE *Sample );
+
+void f_GiveImuToCpu2( void );
+void f_IpcLink_Init( void );
+void f_IpcLink_Publish( DATA_TYPE *Data, Uint16 ErrorCount );
+bool f_IpcLink_Receive( ATT_SAMPLE_TYPE *Sample );
+bool f_IpcMbx_Put( ATT_SAMPLE_TYPE *Rec );
+void f_IpcMbx_Flush( void );
+void f_IpcMbx_Poll( bool Idle );
+Uint16 f_IpcMbx_Get( ATT_SAMPLE_TYPE *Recs, Uint16 MaxRecs );
+void f_IpcMbx_Log( ATT_SAMPLE_TYPE *Recs, Uint16 nRecs );
+Uint16 f_IpcFlag_Wait( Uint16 Flag, Uint32 Timeout_us );
+
+void f_AttPost_Init( float MountYaw, float Alpha );
+#if COMEX_USE_CLA_POST
+bool f_AttPost_Start( RESPONSE_TYPE *Response, CLA_ATT_STATE_TYPE *State );
+bool f_AttPost_Result( CLA_ATT_OUT_TYPE *Out );
+#endif
+bool f_AttPost_Run( CLA_ATT_STATE_TYPE *State, RESPONSE_TYPE *Response, DATA_TYPE *Data );
+void f_AttPost_Reference( CLA_ATT_IN_TYPE *In, CLA_ATT_OUT_TYPE *Out );
+
+void f_AttFilter_Init( ATT_FILTER_TYPE *F, float Kp, float Ki );
+void f_AttFilter_Propagate( ATT_FILTER_TYPE *F, Uint64 Stamp );
+void f_AttFilter_Correct( ATT_FILTER_TYPE *F, DATA_TYPE *Meas, Uint64 Stamp );
+void f_AttFilter_Estimate( ATT_FILTER_TYPE *F, Uint64 Stamp, DATA_TYPE *Out );
+void f_AttFilter_Benchmark( Uint16 nUpdates );
+
+void f_AttPredict_Init( ATT_PREDICT_TYPE *P, Uint16 Mode );
+void f_AttPredict_Add( ATT_PREDICT_TYPE *P, DATA_TYPE *Meas, Uint64 Stamp );
+bool f_AttPredict_Query( ATT_PREDICT_TYPE *P, Uint64 Stamp, DATA_TYPE *Out );
+void f_AttPredict_Check( Uint16 nSamples );
+
+void f_TimeSync_Init( TIME_SYNC_TYPE *S );
+bool f_TimeSync_Add( TIME_SYNC_TYPE *S, Uint32 ImuStamp_us, Uint64 Local );
+Uint64 f_TimeSync_ToLocal( TIME_SYNC_TYPE *S, Uint64 Imu_us );
+void f_TimeSync_Sample( TIME_SYNC_TYPE *S, DATA_TYPE *Data );
+void f_TimeSync_Check( Uint16 nPairs );
+
+void f_Arq_Init( ARQ_TYPE *A );
+bool f_Arq_Room( ARQ_TYPE *A, Uint16 Seq );
+bool f_Arq_Put( ARQ_TYPE *A, Uint16 Seq, PKT_BLOCK_TYPE *Block, Uint64 Stamp );
+PKT_BLOCK_TYPE *f_Arq_Get( ARQ_TYPE *A, Uint64 Now, bool Force, Uint64 *Stamp );
+bool f_Arq_Nak( ARQ_TYPE *A, Uint16 *Seq );
+void f_Arq_Check( Uint16 nPackets );
+
+void f_Fec_Init( void );
+void f_Fec_Encode( unsigned char Byte, unsigned char *Code );
+void f_Fec_Benchmark( Uint16 nPackets );
+
+void f_PollRate_Init( POLL_RATE_TYPE *P, SCI_PORT_TYPE *Port );
+bool f_PollRate_Due( POLL_RATE_TYPE *P );
+Uint32 f_PollRate_Sent( POLL_RATE_TYPE *P );
+void f_PollRate_Answer( POLL_RATE_TYPE *P, SCI_PORT_TYPE *Port, DATA_TYPE *Data );
+void f_PollRate_Error( POLL_RATE_TYPE *P, bool Timeout );
+
+void f_PwmSync_Init( void );
+void f_PwmSync_Start( void );
+void f_PwmSync_Control( Uint64 Now );
+
+void f_Super_Init( void );
+void f_Super_Start( void );
+void f_Super_Task( void );
+void f_Super_Recovered( LINK_TYPE *Link );
+
+void f_PktPool_Init( void );
+PKT_BLOCK_TYPE *f_PktPool_Alloc( void );
+void f_PktPool_Free( PKT_BLOCK_TYPE *Block );
+Uint16 f_PktPool_InUse( void );
+
+void f_Exec_Init( void );
+bool f_Exec_Add( EXEC_FN_TYPE Fn, Uint16 Period, Uint16 Offset );
+void f_Exec_Start( void );
+void f_Exec_Run( void );
+void f_Exec_Tick( void );
+
+extern EXEC_TASK_TYPE g_ExecTasks[EXEC_MAX_TASKS];
+extern EXEC_STATS_TYPE g_ExecStats;
+extern SCI_PORT_TYPE g_SciPorts[SCI_NPORTS];
+extern LINK_TYPE g_Links[LINK_NPORTS];
+extern Uint16 g_LinkPrimary;
+extern TELEM_STATS_TYPE g_TelemStats;
+extern RETAIN_TYPE g_Retain;
+extern SUPER_STATS_TYPE g_SuperStats;
+extern PWM_SYNC_STATS_TYPE g_PwmSyncStats;
+extern PKT_POOL_STATS_TYPE g_PktPoolStats;
+extern PARSER_BENCH_TYPE g_ParserBench;
+extern BOOT_TIMES_TYPE g_BootTimes;
+
+#ifdef _FLASH
+/* Load/run addresses of the sections f_MemCfg_Init copies (COMEX_Sections.cmd) */
+extern Uint16 HotCodeLoadStart, HotCodeLoadSize, HotCodeRunStart;
+extern Uint16 Cla1ProgLoadStart, Cla1ProgLoadSize, Cla1ProgRunStart;
+extern Uint16 Cla1ConstLoadStart, Cla1ConstLoadSize, Cla1ConstRunStart;
+#endif
+extern ATT_SNAPSHOT_TYPE g_AttSnapshot;
+extern ATT_FILTER_TYPE g_AttFilter;
+extern ATT_FILTER_BENCH_TYPE g_AttFilterBench;
+extern ATT_PREDICT_TYPE g_AttPredict;
+extern ATT_PREDICT_CHECK_TYPE g_AttPredictCheck;
+extern TIME_SYNC_CHECK_TYPE g_TimeSyncCheck;
+extern Uint16 g_FecLut[256];
+extern ARQ_CHECK_TYPE g_ArqCheck;
+extern FEC_BENCH_TYPE g_FecBench;
+extern ATT_POST_STATS_TYPE g_AttPostStats;
+extern IPC_LINK_STATS_TYPE g_IpcLinkStats;
+extern IPC_LOG_TYPE g_IpcLog;
 
 
 
@@ -0,0 +1,65 @@
+/*
+ * COMEX_RAM_lnk_cpu2.cmd
+ *
+ *  CPU2 RAM build memory map, in place of the device
+ *  2837xD_RAM_lnk_cpu2.cmd (C2000Ware 1.00) which it follows
+ *  except for .text: kept out of RAMLS1-RAMLS4 (COMEX_Sections.cmd)
+ *  in M0, D0, LS0 and D1 (moved to page 0). The GS blocks belong
+ *  to CPU1 unless it hands them over, so none are used for code.
+ *  Linked in CPU2_RAM only (.cproject).
+ */
+
+MEMORY
+{
+PAGE 0 :
+   /* BEGIN is used for the "boot to SARAM" bootloader mode */
+   BEGIN           : origin = 0x000000, length = 0x000002
+   RAMM0           : origin = 0x000122, length = 0x0002DE
+   RAMD0           : origin = 0x00B000, length = 0x000800
+   RAMD1           : origin = 0x00B800, length = 0x000800
+   RAMLS0          : origin = 0x008000, length = 0x000800
+   RAMLS1          : origin = 0x008800, length = 0x000800
+   RAMLS2          : origin = 0x009000, length = 0x000800
+   RAMLS3          : origin = 0x009800, length = 0x000800
+   RAMLS4          : origin = 0x00A000, length = 0x000800
+   RESET           : origin = 0x3FFFC0, length = 0x000002
+
+PAGE 1 :
+   BOOT_RSVD       : origin = 0x000002, length = 0x000120  /* Part of M0, BOOT rom will use this for stack */
+   RAMM1           : origin = 0x000400, length = 0x000400
+   RAMLS5          : origin = 0x00A800, length = 0x000800
+
+   CPU2TOCPU1RAM   : origin = 0x03F800, length = 0x000400
+   CPU1TOCPU2RAM   : origin = 0x03FC00, length = 0x000400
+}
+
+SECTIONS
+{
+   codestart        : > BEGIN,     PAGE = 0
+   .TI.ramfunc      : {} > RAMM0,  PAGE = 0
+   .text            : >> RAMM0 | RAMD0 | RAMLS0 | RAMD1, PAGE = 0
+   .cinit           : > RAMM0,     PAGE = 0
+   .pinit           : > RAMM0,     PAGE = 0
+   .switch          : > RAMM0,     PAGE = 0
+   .reset           : > RESET,     PAGE = 0, TYPE = DSECT /* not used */
+
+   .stack           : > RAMM1,     PAGE = 1
+   .ebss            : > RAMLS5,    PAGE = 1
+   .econst          : > RAMLS5,    PAGE = 1
+   .esysmem         : > RAMLS5,    PAGE = 1
+
+   /* The following section definitions are required when using the IPC API Drivers */
+   GROUP : > CPU2TOCPU1RAM, PAGE = 1
+   {
+       PUTBUFFER
+       PUTWRITEIDX
+       GETREADIDX
+   }
+
+   GROUP : > CPU1TOCPU2RAM, PAGE = 1
+   {
+       GETBUFFER :    TYPE = DSECT
+       GETWRITEIDX :  TYPE = DSECT
+       PUTREADIDX :   TYPE = DSECT
+   }
+}
@@ -0,0 +1,71 @@
+/*
+ * COMEX_Sections.cmd
+ *
+ *  Project sections, linked in addition to the memory map:
+ *  COMEX_RAM_lnk_cpuX.cmd in the RAM builds (the device map with
+ *  .text kept out of RAMLS1-RAMLS4), the device
+ *  2837xD_FLASH_lnk_cpu1.cmd in the flash build (.text in flash).
+ *  Only adds what those files do not already describe.
+ *
+ *  LS block use (ownership set by f_MemCfg_Init, LSx_OWNER):
+ *    RAMLS1  CPU data     receive rings, packet pool, sample histories, trace
+ *                         statistics, retained statistics (NOINIT, survive
+ *                         a reset). The links and the telemetry buffers
+ *                         are in .ebss, they would not fit here
+ *    RAMLS2  CPU code     hot code (ISRs, parser, attitude math, checksum, executive)
+ *    RAMLS3  CLA data
+ *    RAMLS4  CLA program
+ *  tools/map_report.py prints the headroom of every RAM block
+ *  after the link and fails if anything else lands in LS1-LS4.
+ */
+
+/* CLA C compiler scratchpad */
+CLA_SCRATCHPAD_SIZE = 0x100;
+--undef_sym=__cla_scratchpad_end
+--undef_sym=__cla_scratchpad_start
+
+MEMORY
+{
+PAGE 1 :
+   CLA1_MSGRAMLOW   : origin = 0x001480, length = 0x000080
+   CLA1_MSGRAMHIGH  : origin = 0x001500, length = 0x000080
+}
+
+SECTIONS
+{
+   /* CPU data */
+   ComexRxRing      : > RAMLS1, PAGE = 0
+   ComexPool        : > RAMLS1, PAGE = 0
+   ComexHistory     : > RAMLS1, PAGE = 0
+   ComexTrace       : > RAMLS1, PAGE = 0
+   ComexRetain      : > RAMLS1, PAGE = 0, type = NOINIT
+
+   /* Hot code (LS2), CLA program (LS4) and data (LS3).
+   ** The flash build (linker --define=_FLASH) loads the hot code,
+   ** the CLA program and the CLA constants into flash and
+   ** f_MemCfg_Init copies them across */
+#ifdef _FLASH
+   ComexHotCode     : LOAD = FLASHD, RUN = RAMLS2,
+                      LOAD_START(_HotCodeLoadStart), LOAD_SIZE(_HotCodeLoadSize),
+                      RUN_START(_HotCodeRunStart),
+                      PAGE = 0
+   Cla1Prog         : LOAD = FLASHD, RUN = RAMLS4,
+                      LOAD_START(_Cla1ProgLoadStart), LOAD_SIZE(_Cla1ProgLoadSize),
+                      RUN_START(_Cla1ProgRunStart),
+                      PAGE = 0, ALIGN(4)
+   .const_cla       : LOAD = FLASHB, RUN = RAMLS3,
+                      LOAD_START(_Cla1ConstLoadStart), LOAD_SIZE(_Cla1ConstLoadSize),
+                      RUN_START(_Cla1ConstRunStart),
+                      PAGE = 0
+#else
+   ComexHotCode     : > RAMLS2, PAGE = 0
+   Cla1Prog         : > RAMLS4, PAGE = 0
+   .const_cla       : > RAMLS3, PAGE = 0
+#endif
+
+   .scratchpad      : > RAMLS3, PAGE = 0
+   .bss_cla         : > RAMLS3, PAGE = 0
+
+   Cla1ToCpuMsgRAM  : > CLA1_MSGRAMLOW,  PAGE = 1
+   CpuToCla1MsgRAM  : > CLA1_MSGRAMHIGH, PAGE = 1
+}
@@ -0,0 +1,196 @@
+/*
+ * Executive.c
+ *
+ *  Fixed rate executive. CPU Timer 0 (ePWM1 with COMEX_USE_PWM_SYNC,
+ *  Pwm_Sync.c) interrupts every EXEC_TICK_US and only counts ticks;
+ *  f_Exec_Run, called from the main loop, runs every registered
+ *  task whose release tick has come round.
+ *  Tasks must not block. The RX ISR and the CLA interrupt still
+ *  preempt them.
+ *
+ *  Per task the executive keeps run counts and, with COMEX_INSTRUMENT
+ *  at INSTR_TIMING or up, execution time and release latency (IPC
+ *  counter cycles). A task which is still
+ *  running when its next release is due counts as an overrun, and
+ *  the missed releases are skipped rather than run back to back.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#pragma DATA_SECTION(g_ExecTasks, "ComexTrace");
+#pragma DATA_SECTION(g_ExecStats, "ComexTrace");
+EXEC_TASK_TYPE  g_ExecTasks[EXEC_MAX_TASKS];
+EXEC_STATS_TYPE g_ExecStats;
+
+/* Written by the tick ISR only (f_Exec_Tick) */
+static volatile Uint32 s_ExecTick;
+static volatile Uint32 s_ExecTickStamp;  /* Low word of the IPC counter */
+
+/* Last tick dispatched */
+static Uint32 s_ExecLastTick;
+
+__interrupt void f_Timer0Isr( void );
+
+#pragma CODE_SECTION(f_Timer0Isr, "ComexHotCode");
+#pragma CODE_SECTION(f_Exec_Tick, "ComexHotCode");
+#pragma CODE_SECTION(f_Exec_Run, "ComexHotCode");
+
+
+
+/*
+** f_Exec_Init
+** Empty the task table and set up (but don't start) CPU Timer 0,
+** or the ePWM time bases */
+void f_Exec_Init( void )
+{
+    memset( g_ExecTasks, 0, sizeof(g_ExecTasks) );
+    memset( &g_ExecStats, 0, sizeof(EXEC_STATS_TYPE) );
+    s_ExecTick     = 0;
+    s_ExecLastTick = 0;
+
+#if COMEX_USE_PWM_SYNC
+    f_PwmSync_Init();
+#else
+    /* Timer 0 counts SYSCLK, no prescale */
+    CpuTimer0Regs.TCR.bit.TSS = 1;
+    CpuTimer0Regs.PRD.all     = (Uint32)COMEX_SYSCLK_MHZ*EXEC_TICK_US - 1;
+    CpuTimer0Regs.TPR.all     = 0;
+    CpuTimer0Regs.TPRH.all    = 0;
+    CpuTimer0Regs.TCR.bit.TRB = 1;
+    CpuTimer0Regs.TCR.bit.TIE = 1;
+
+    EALLOW;
+    PieVectTable.TIMER0_INT = &f_Timer0Isr;
+    EDIS;
+
+    PieCtrlRegs.PIEIER1.bit.INTx7 = 1;  // Timer 0 is PIE 1.7
+    IER |= M_INT1;
+#endif
+} /* End f_Exec_Init */
+
+
+
+/*
+** f_Exec_Add
+** Register Fn to run every Period ticks, first at tick Offset.
+** Offsets let tasks with the same period share the load.
+** Returns FALSE if the table is full or Period is 0 */
+bool f_Exec_Add( EXEC_FN_TYPE Fn, Uint16 Period, Uint16 Offset )
+{
+    EXEC_TASK_TYPE *T;
+
+    if( (g_ExecStats.nTasks >= EXEC_MAX_TASKS) || (Period == 0) ) { return( FALSE ); }
+
+    T = &g_ExecTasks[g_ExecStats.nTasks];
+    T->Fn      = Fn;
+    T->Period  = Period;
+    T->Next    = s_ExecTick + 1 + Offset;
+    T->ExecMin = 0xFFFFFFFF;
+
+    g_ExecStats.nTasks++;
+    return( TRUE );
+} /* End f_Exec_Add */
+
+
+
+/*
+** f_Exec_Start
+** Start ticking. Interrupts must be enabled (EINT) by the caller */
+void f_Exec_Start( void )
+{
+    s_ExecLastTick = s_ExecTick;
+#if COMEX_USE_PWM_SYNC
+    f_PwmSync_Start();
+#else
+    CpuTimer0Regs.TCR.bit.TSS = 0;
+#endif
+} /* End f_Exec_Start */
+
+
+
+/*
+** f_Exec_Run
+** Dispatch the tasks due on the latest tick. Returns at once if
+** no tick has passed, so it is called from the main loop as often
+** as possible */
+void f_Exec_Run( void )
+{
+    Uint16 i;
+    Uint32 Tick;
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+    Uint32 Release, Start, Elapsed;
+#endif
+    EXEC_TASK_TYPE *T;
+
+    Tick = s_ExecTick;
+    if( Tick == s_ExecLastTick ) { return; }
+
+    /* A whole tick went by without us getting here */
+    if( Tick - s_ExecLastTick > 1 )
+    {
+        g_ExecStats.MissedTicks += Tick - s_ExecLastTick - 1;
+    }
+    s_ExecLastTick = Tick;
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+    Release = s_ExecTickStamp;
+#endif
+    g_ExecStats.Ticks++;
+
+    for( i=0; i<g_ExecStats.nTasks; i++ )
+    {
+        T = &g_ExecTasks[i];
+        if( (int32_t)(Tick - T->Next) < 0 ) { continue; }
+
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+        Start = (Uint32)ReadIpcTimer();
+        T->Fn();
+        Elapsed = (Uint32)ReadIpcTimer() - Start;
+
+        T->ExecLast = Elapsed;
+        T->ExecSum += Elapsed;
+        if( Elapsed > T->ExecMax ) { T->ExecMax = Elapsed; }
+        if( Elapsed < T->ExecMin ) { T->ExecMin = Elapsed; }
+        if( Start - Release > T->LatencyMax ) { T->LatencyMax = Start - Release; }
+#else
+        T->Fn();
+#endif
+        T->Runs++;
+
+        /* Next release. If that has passed already the task overran:
+        ** skip to the next one in the future */
+        T->Next += T->Period;
+        if( (int32_t)(s_ExecTick - T->Next) >= 0 )
+        {
+            T->Overruns++;
+            T->Next = s_ExecTick + T->Period;
+        }
+    }
+
+    /* Everything due this tick should be done before the next one */
+    if( s_ExecTick != Tick ) { g_ExecStats.FrameOverruns++; }
+} /* End f_Exec_Run */
+
+
+
+/*
+** f_Exec_Tick
+** Count a tick. From the tick ISR only */
+void f_Exec_Tick( void )
+{
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+    s_ExecTickStamp = (Uint32)ReadIpcTimer();
+#endif
+    s_ExecTick++;
+} /* End f_Exec_Tick */
+
+
+
+/*
+** f_Timer0Isr
+** Executive tick */
+__interrupt void f_Timer0Isr( void )
+{
+    f_Exec_Tick();
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+} /* End f_Timer0Isr */
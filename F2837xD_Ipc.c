@@ -85,7 +85,10 @@ void InitIpc()
 //
 // ReadIpcTimer - Read the current IPC timer value. The low register must be
 //                read first to latch a value in the high register.
+//                Stamps every received byte, so it is placed with the
+//                project hot code (COMEX_Sections.cmd).
 //
+#pragma CODE_SECTION(ReadIpcTimer, "ComexHotCode");
 unsigned long long ReadIpcTimer()
 {
     Uint32 low, high;
@@ -120,7 +123,7 @@ void SendIpcData(void *data, Uint16 word_length, Uint16 flag)
 void RecvIpcData(void *recv_buf, Uint16 word_length)
 {
     word_length = (word_length < MSG_RAM_SIZE) ? word_length : MSG_RAM_SIZE;
-    memcpy(RECV_MSG_RAM, recv_buf, word_length);
+    memcpy(recv_buf, RECV_MSG_RAM, word_length);
 }
 
 //
@@ -0,0 +1,210 @@
+/*
+ * Fec.c
+ *
+ *  Forward error correction on the IMU links (COMEX_USE_FEC).
+ *
+ *  The IMU sends every byte of a packet, length field included, as
+ *  two extended Hamming(8,4) codewords, high nibble first. Each
+ *  codeword carries 4 data bits, 3 Hamming parity bits and an
+ *  overall parity bit:
+ *      bit  7   6   5   4   3   2   1   0
+ *           p0  d3  d2  d1  p3  d0  p2  p1
+ *  so any one bit error in a codeword is corrected in place and any
+ *  two are detected. The RX ISR (f_SciRxService) decodes through
+ *  g_FecLut, one lookup per received character, before framing, so
+ *  the framer, checksum and decoder never see the code. A codeword
+ *  with two or more errors decodes to the nearest nibble and is
+ *  counted; the packet checksum throws the packet out as before.
+ *  A burst that hits both halves of a byte is still a lost packet.
+ *
+ *  The line carries twice the characters, so FEC only pays where
+ *  the baud is there to spare and bit errors are the limit.
+ *  f_Fec_Benchmark (INSTR_BENCH) measures the decode cost per packet
+ *  and the goodput of plain and coded packets at a few injected bit
+ *  error rates on target, tools/fec_goodput.py gives the expected
+ *  curves.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#if COMEX_USE_FEC
+
+#pragma DATA_SECTION(g_FecLut, "ComexRxRing");
+Uint16 g_FecLut[256];
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+FEC_BENCH_TYPE g_FecBench;
+#endif
+
+/* Codeword of every nibble, see the bit layout above */
+static const unsigned char s_FecCode[16] =
+{
+    0x00, 0x87, 0x99, 0x1E, 0xAA, 0x2D, 0x33, 0xB4,
+    0x4B, 0xCC, 0xD2, 0x55, 0xE1, 0x66, 0x78, 0xFF
+};
+
+
+
+/*
+** f_FecWeight
+** Number of bits set in a byte */
+static Uint16 f_FecWeight( Uint16 Bits )
+{
+    Uint16 n = 0;
+
+    for( ; Bits != 0; Bits &= Bits - 1 ) { n++; }
+    return( n );
+} /* End f_FecWeight */
+
+
+
+/*
+** f_Fec_Init
+** Build the decode table: every received character to its nearest
+** codeword's nibble, flagged FEC_CORRECTED at distance 1 and
+** FEC_BAD beyond. Call before any RX interrupt is enabled */
+void f_Fec_Init( void )
+{
+    Uint16 Rx, Nibble, Dist, Best, BestDist;
+
+    for( Rx=0; Rx<256; Rx++ )
+    {
+        Best     = 0;
+        BestDist = 8;
+        for( Nibble=0; Nibble<16; Nibble++ )
+        {
+            Dist = f_FecWeight( Rx ^ s_FecCode[Nibble] );
+            if( Dist < BestDist ) { Best = Nibble; BestDist = Dist; }
+        }
+
+        g_FecLut[Rx] = Best;
+        if( BestDist == 1 )     { g_FecLut[Rx] |= FEC_CORRECTED; }
+        else if( BestDist > 1 ) { g_FecLut[Rx] |= FEC_BAD; }
+    }
+} /* End f_Fec_Init */
+
+
+
+/*
+** f_Fec_Encode
+** Byte to its two codewords, high nibble first (what the IMU sends) */
+void f_Fec_Encode( unsigned char Byte, unsigned char *Code )
+{
+    Code[0] = s_FecCode[(Byte >> 4) & 0xF];
+    Code[1] = s_FecCode[Byte & 0xF];
+} /* End f_Fec_Encode */
+
+
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+/*
+** f_FecRandom
+** xorshift32, good enough to place bit errors */
+static Uint32 f_FecRandom( Uint32 *State )
+{
+    Uint32 x = *State;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *State = x;
+    return( x );
+} /* End f_FecRandom */
+
+
+
+/*
+** f_FecFlip
+** Flip each of the 8 bits of Byte with probability Threshold/2^32 */
+static unsigned char f_FecFlip( unsigned char Byte, Uint32 Threshold, Uint32 *Rand )
+{
+    Uint16 b;
+
+    for( b=0; b<8; b++ )
+    {
+        if( f_FecRandom( Rand ) < Threshold ) { Byte ^= (1 << b); }
+    }
+    return( Byte );
+} /* End f_FecFlip */
+
+
+
+/*
+** f_Fec_Benchmark
+** nPackets canned type 2 packets (FEC_BENCH_BYTES on the wire
+** uncoded) through a channel with each of the FEC_BENCH_BER bit
+** error rates, plain and coded. A plain packet survives with no
+** bit error, a coded one when every byte decodes back exactly.
+** Goodput is surviving packets per character time, relative to a
+** clean plain link, so coded tops out at 0.5. DecodeCycles is one
+** coded packet through g_FecLut as the RX ISR does it */
+void f_Fec_Benchmark( Uint16 nPackets )
+{
+    static const Uint16 BerPpm[FEC_BENCH_NBER] = FEC_BENCH_BER;
+    unsigned char Packet[FEC_BENCH_BYTES];
+    unsigned char Code[2*FEC_BENCH_BYTES];
+    Uint16 i, j, k, Code0, Code1, Flags;
+    Uint16 PlainGood, FecGood;
+    Uint32 Threshold, Corrected;
+    Uint32 Rand = 0x2545F491UL;
+    Uint64 Start, Cycles = 0;
+    bool Ok;
+
+    memset( &g_FecBench, 0, sizeof(FEC_BENCH_TYPE) );
+
+    for( j=0; j<FEC_BENCH_BYTES; j++ ) { Packet[j] = 0x40 + j; }
+
+    for( k=0; k<FEC_BENCH_NBER; k++ )
+    {
+        Threshold = (Uint32)(((Uint64)BerPpm[k] << 32) / 1000000UL);
+        PlainGood = 0;
+        FecGood   = 0;
+        Corrected = 0;
+
+        for( i=0; i<nPackets; i++ )
+        {
+            /* Plain */
+            Ok = TRUE;
+            for( j=0; j<FEC_BENCH_BYTES; j++ )
+            {
+                if( f_FecFlip( Packet[j], Threshold, &Rand ) != Packet[j] ) { Ok = FALSE; }
+            }
+            if( Ok ) { PlainGood++; }
+
+            /* Coded */
+            for( j=0; j<FEC_BENCH_BYTES; j++ )
+            {
+                f_Fec_Encode( Packet[j], &Code[2*j] );
+                Code[2*j]   = f_FecFlip( Code[2*j],   Threshold, &Rand );
+                Code[2*j+1] = f_FecFlip( Code[2*j+1], Threshold, &Rand );
+            }
+
+            Ok    = TRUE;
+            Start = ReadIpcTimer();
+            for( j=0; j<FEC_BENCH_BYTES; j++ )
+            {
+                Code0 = g_FecLut[Code[2*j]];
+                Code1 = g_FecLut[Code[2*j+1]];
+                Flags = (Code0 | Code1) & (FEC_CORRECTED | FEC_BAD);
+                if( Flags & FEC_CORRECTED ) { Corrected++; }
+                if( ((((Code0 & 0xF) << 4) | (Code1 & 0xF))) != Packet[j] ) { Ok = FALSE; }
+            }
+            Cycles += ReadIpcTimer() - Start;
+            if( Ok ) { FecGood++; }
+        }
+
+        g_FecBench.BerPpm[k]       = BerPpm[k];
+        g_FecBench.PlainGood[k]    = PlainGood;
+        g_FecBench.FecGood[k]      = FecGood;
+        g_FecBench.Corrected[k]    = Corrected;
+        g_FecBench.PlainGoodput[k] = (nPackets > 0) ? (float)PlainGood / nPackets : 0.0f;
+        g_FecBench.FecGoodput[k]   = (nPackets > 0) ? (float)FecGood / (2.0f*nPackets) : 0.0f;
+    }
+
+    g_FecBench.Packets      = nPackets;
+    g_FecBench.DecodeCycles = (nPackets > 0) ? (Uint32)(Cycles / ((Uint32)nPackets*FEC_BENCH_NBER)) : 0;
+} /* End f_Fec_Benchmark */
+#endif
+
+#endif /* COMEX_USE_FEC */
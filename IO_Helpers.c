@@ -7,6 +7,19 @@
 
 #include "COMEX_Proj.h"
 
+/* Hot path, runs from LS RAM in every build (see COMEX_Sections.cmd) */
+#pragma CODE_SECTION(f_DecodePacket, "ComexHotCode");
+#pragma CODE_SECTION(f_UnpackFloat_s32, "ComexHotCode");
+#pragma CODE_SECTION(f_UnpackInt_u16, "ComexHotCode");
+#pragma CODE_SECTION(f_CheckSum, "ComexHotCode");
+#pragma CODE_SECTION(f_PacketOk, "ComexHotCode");
+#if COMEX_PKT_QUAT_Q14
+#pragma CODE_SECTION(f_UnpackFloat_q14, "ComexHotCode");
+#endif
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+PARSER_BENCH_TYPE g_ParserBench;
+#endif
 
 
 
@@ -33,41 +46,78 @@
 **    case 2:
 **      16 bit debug character (0xB1)
 **      Sent as a 16 bit integer
+**    case 3:
+**      Quaternion as 4 x Q14 fixed point
+**    case 4:
+**      Quaternion as 4 x 32 bit floats
+**    case 5:
+**      As case 2, then the IMU's sample time
+**      (u32, us, free running)
+**
+** Attitude packets fill both the Euler and the
+** quaternion fields of Data. Types switched off in
+** COMEX_Config.h are not decoded
 **
+** Returns IO_TIMEOUT (Data and Response untouched) if no
+** complete packet arrives on Port within Timeout_us
 */
-void f_GetPacket( DATA_TYPE *Data, RESPONSE_TYPE *Response )
+Uint16 f_GetPacket( SCI_PORT_TYPE *Port, DATA_TYPE *Data, RESPONSE_TYPE *Response, Uint32 Timeout_us )
 {
-  int i;
-  unsigned char Buffer[100];
-
-  /* The first 2 bytes contain the length of the packet */
-  while( (ScibRegs.SCIFFRX.bit.RXFFST == 0) ) {}
-  Buffer[0] = ScibRegs.SCIRXBUF.bit.SAR;
-  while( (ScibRegs.SCIFFRX.bit.RXFFST == 0) ) {}
-  Buffer[1] = ScibRegs.SCIRXBUF.bit.SAR;
-  Response->Packet_nBytes = (Buffer[0]<<8) | (Buffer[1]);
+  RX_FRAME_TYPE Frame;
+  DEADLINE_TYPE Deadline = f_Deadline_Set( Timeout_us );
 
-  /* Read the entire packet and store in a buffer */
-  for( i=0; i<Response->Packet_nBytes; i++)
+  /* Wait for the RX ISR to complete a packet */
+  while( f_RxFrameGet( Port, &Frame ) == FALSE )
   {
-      while( (ScibRegs.SCIFFRX.bit.RXFFST == 0) ) {}
-      Buffer[i] = ScibRegs.SCIRXBUF.bit.SAR;
+    if( f_Deadline_Expired( Deadline ) ) { return( IO_TIMEOUT ); }
   }
 
+  f_DecodePacket( &Frame, Data, Response );
+  return( IO_OK );
+} /* End f_GetPacket */
+
+
+
+/*
+** f_DecodePacket
+** Decode a packet framed by the RX ISR (see f_GetPacket
+** for the format) and copy its arrival stamps into Data */
+void f_DecodePacket( RX_FRAME_TYPE *Frame, DATA_TYPE *Data, RESPONSE_TYPE *Response )
+{
+  int i;
+  unsigned char *Buffer = &Frame->Bytes[0];
+
+  Response->Packet_nBytes = Frame->nBytes;
+
   /* The first byte pair is the packet type */
   Response->PacketType = (Buffer[0]<<8) | (Buffer[1]);
 
   /* The second byte pair is the length of the data buffer */
   Response->Buffer_nBytes = (Buffer[2]<<8) | (Buffer[3]);
 
+  /* Never read past what was actually received */
+  if( Response->Buffer_nBytes > Frame->nBytes - 2*2 - 1 )
+  {
+    Response->Buffer_nBytes = Frame->nBytes - 2*2 - 1;
+  }
+
   /* Read the data buffer and copy to new array */
   for( i=0; i<Response->Buffer_nBytes; i++)
   {
     Response->Buffer[i] = Buffer[2*2 + i];
   }
 
+  /* Arrival time of the first and last byte. The sample time
+  ** stays the arrival unless Time_Sync.c can do better */
+  Data->RxFirstStamp = Frame->FirstStamp;
+  Data->RxLastStamp  = Frame->LastStamp;
+  Data->SampleStamp  = Frame->FirstStamp;
+  Data->HasImuStamp  = FALSE;
+  Data->HasSeq       = FALSE;
+
   switch ( Response->PacketType )
   {
+#if COMEX_PKT_DEBUG
     /* Packet type 11
     ** Debug test byte
     ** Data buffer
@@ -85,6 +135,7 @@ void f_GetPacket( DATA_TYPE *Data, RESPONSE_TYPE *Response )
     case 12:
       f_UnpackFloat_s32( &Response->Buffer[0], &Data->Test_F32 );
       break;
+#endif
 
     /* Packet type 1
     ** Roll pitch yaw data
@@ -92,24 +143,77 @@ void f_GetPacket( DATA_TYPE *Data, RESPONSE_TYPE *Response )
     **    3 x 16 bit fixed point floats
     **    Each element is shifted 7 bits
     **    floats are signed */
+#if COMEX_PKT_EULER_Q7
     case 1:
-      /* Unpack the data (assuming 2 byte float) into Data array */
-      f_UnpackFloat_s16( &Response->Buffer[0], &Data->Roll );
-      f_UnpackFloat_s16( &Response->Buffer[SFLOAT*1], &Data->Pitch );
-      f_UnpackFloat_s16( &Response->Buffer[SFLOAT*2], &Data->Yaw );
+      /* Angles: f_AttPost_Run */
       break;
+#endif
 
     /* Packet type 2
     ** Roll pitch yaw data
     ** Data buffer:
     **    3 x 32 bit floats
     **    floats are sent bit for bit */
+#if COMEX_PKT_EULER_F32
     case 2:
-      /* Unpack the data (assuming 2 byte float) into Data array */
-      f_UnpackFloat_s32( &Response->Buffer[0], &Data->Roll );
-      f_UnpackFloat_s32( &Response->Buffer[SFLOAT*1], &Data->Pitch );
-      f_UnpackFloat_s32( &Response->Buffer[SFLOAT*2], &Data->Yaw );
+      /* Angles: f_AttPost_Run */
+      break;
+#endif
+
+    /* Packet type 5
+    ** Roll pitch yaw data and the IMU's sample time
+    ** Data buffer:
+    **    3 x 32 bit floats, sent bit for bit
+    **    u32 IMU clock at the sample (us) */
+#if COMEX_PKT_EULER_F32_TS
+    case 5:
+      f_UnpackInt_u32( &Response->Buffer[SFLOAT*2*3], &Data->ImuStamp_us );
+      Data->HasImuStamp = TRUE;
+      break;
+#endif
+
+    /* Packet type 6
+    ** Roll pitch yaw data and the IMU's packet sequence number
+    ** Data buffer:
+    **    3 x 32 bit floats, sent bit for bit
+    **    u16 sequence number, one more for every new packet */
+#if COMEX_PKT_EULER_F32_SEQ
+    case 6:
+      Data->Seq    = (Response->Buffer[SFLOAT*2*3] << 8) | Response->Buffer[SFLOAT*2*3 + 1];
+      Data->HasSeq = TRUE;
+      break;
+#endif
+
+    /* Packet type 3
+    ** Quaternion (w, x, y, z)
+    ** Data buffer:
+    **    4 x 16 bit fixed point
+    **    Each element is shifted 14 bits
+    **    elements are signed */
+#if COMEX_PKT_QUAT_Q14
+    case 3:
+      for( i=0; i<4; i++ )
+      {
+        f_UnpackFloat_q14( &Response->Buffer[SFLOAT*i], &Data->Quat[i] );
+      }
+      f_QuatNormalize( &Data->Quat[0] );
+      break;
+#endif
+
+    /* Packet type 4
+    ** Quaternion (w, x, y, z)
+    ** Data buffer:
+    **    4 x 32 bit floats
+    **    floats are sent bit for bit */
+#if COMEX_PKT_QUAT_F32
+    case 4:
+      for( i=0; i<4; i++ )
+      {
+        f_UnpackFloat_s32( &Response->Buffer[SFLOAT*2*i], &Data->Quat[i] );
+      }
+      f_QuatNormalize( &Data->Quat[0] );
       break;
+#endif
 
 
     /* Undetermined case */
@@ -117,14 +221,32 @@ void f_GetPacket( DATA_TYPE *Data, RESPONSE_TYPE *Response )
       Data->Test_uI16 = 0xAA;
   }
 
+  /* Give consumers both attitude forms. The RPY packets' angles
+  ** are post-processed, and f_AttPost_Run fills in both */
+  if( (Response->PacketType == 3) || (Response->PacketType == 4) )
+  {
+    f_QuatToEuler( &Data->Quat[0], &Data->Roll, &Data->Pitch, &Data->Yaw );
+  }
+
   /* Read IMU calculated checksum */
   Response->CheckSum = Buffer[Response->Packet_nBytes-1];
 
-} /* End f_GetPacket */
+} /* End f_DecodePacket */
+
+
 
+/*
+** f_SampleAge_us
+** Time since the last byte of Data's packet arrived */
+Uint32 f_SampleAge_us( DATA_TYPE *Data )
+{
+  return( (Uint32)((ReadIpcTimer() - Data->RxLastStamp) / IPC_TICKS_PER_US) );
+} /* End f_SampleAge_us */
 
 
 
+
+#if COMEX_USE_GENERIC_UNPACK
 /*
 ** f_UnpackFloat_u16
 ** This code converts 2 x 8 bit characters (sent from IMU)
@@ -140,8 +262,28 @@ void f_UnpackFloat_s16( unsigned char *Packet, float *Output )
   *Output /= div;
 
 } /* End f_UnpackFloat_u16 */
+#endif
 
 
+#if COMEX_PKT_QUAT_Q14
+/*
+** f_UnpackFloat_q14
+** This code converts 2 x 8 bit characters (sent from IMU)
+** into a float in [-2,2)
+** Characters are sent from a 16 bit signed Q14 integer */
+void f_UnpackFloat_q14( unsigned char *Packet, float *Output )
+{
+  int hpFloat = 0;
+  float div   = 16384.0f; /* shift right 14 bits */
+
+  hpFloat = (Packet[0] << 8) | (Packet[1]);
+  *Output = (float)hpFloat;
+  *Output /= div;
+} /* End f_UnpackFloat_q14 */
+#endif
+
+
+#if COMEX_USE_GENERIC_UNPACK
 /*
 ** f_UnpackFloat_u16
 ** This code converts the 2 x 8 bit characters (sent from IMU)
@@ -156,6 +298,7 @@ void f_UnpackFloat_u16( unsigned char *Packet, float *Output )
   *Output = (float)hpFloat;
   *Output /= div;
 } /* End f_UnpackFloat_u16 */
+#endif
 
 
 /*
@@ -179,6 +322,7 @@ void f_UnpackFloat_s32( unsigned char *Packet, float *Output )
 } /* End f_UnpackFloat_u16 */
 
 
+#if COMEX_USE_GENERIC_UNPACK
 /*
 ** f_UnpackInt_s16
 ** This code converts the 2 x 8 bit characters (sent from IMU)
@@ -189,6 +333,7 @@ void f_UnpackInt_s16( unsigned char *Packet, int *Output )
   /* We simply mask two adjacent characters in the data buffer */
   *Output = (Packet[0] << 8) | (Packet[1]);
 }
+#endif
 
 /*
 ** f_UnpackInt_u16
@@ -220,22 +365,95 @@ unsigned char f_CheckSum( unsigned char *p_Buffer, uint16_t nBytes )
 
 
 /*
-** f_xmit_char
-** Transmit a single character */
-void f_xmit_char( char xmitChar )
+** f_PacketOk
+** Integrity check of a decoded packet, as set by COMEX_INTEGRITY */
+bool f_PacketOk( RESPONSE_TYPE *Response )
+{
+#if COMEX_INTEGRITY == INTEGRITY_SUM8
+  return( f_CheckSum( &Response->Buffer[0], Response->Buffer_nBytes ) == Response->CheckSum );
+#else
+  return( TRUE );
+#endif
+} /* End f_PacketOk */
+
+
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+/*
+** f_Parser_Benchmark
+** Time f_DecodePacket and f_CheckSum on a canned type 2 packet.
+** The IPC counter runs at SYSCLK, so ticks are cycles. Run the
+** RAM and the flash build and compare g_ParserBench: with the
+** parser in ComexHotCode (LS RAM) the counts should match */
+void f_Parser_Benchmark( Uint16 nRuns )
 {
-    /* Transmit "xmitChar" */
-    //while (ScibRegs.SCICTL2.bit.TXEMPTY == 0) {}
-    ScibRegs.SCITXBUF.all = xmitChar;
-} /* End f_xmit_char */
+    Uint16 i;
+    RX_FRAME_TYPE Frame;
+    RESPONSE_TYPE Response;
+    DATA_TYPE Data;
+    Uint64 Start, Decode, Sum;
+
+    memset( &Frame, 0, sizeof(RX_FRAME_TYPE) );
+    Frame.nBytes   = 2*2 + 12 + 1;
+    Frame.Bytes[1] = 2;      /* Packet type 2 */
+    Frame.Bytes[3] = 12;     /* 3 x 32 bit floats */
+    for( i=0; i<12; i++ ) { Frame.Bytes[2*2 + i] = 0x40 + i; }
+    Frame.Bytes[Frame.nBytes-1] = f_CheckSum( &Frame.Bytes[2*2], 12 );
+
+    Decode = 0;
+    Sum    = 0;
+    for( i=0; i<nRuns; i++ )
+    {
+        Start   = ReadIpcTimer();
+        f_DecodePacket( &Frame, &Data, &Response );
+        Decode += ReadIpcTimer() - Start;
+
+        Start = ReadIpcTimer();
+        f_CheckSum( &Response.Buffer[0], Response.Buffer_nBytes );
+        Sum  += ReadIpcTimer() - Start;
+    }
+
+    g_ParserBench.Runs           = nRuns;
+    g_ParserBench.DecodeCycles   = (nRuns > 0) ? (Uint32)(Decode / nRuns) : 0;
+    g_ParserBench.CheckSumCycles = (nRuns > 0) ? (Uint32)(Sum / nRuns) : 0;
+#ifdef _FLASH
+    g_ParserBench.Flash = TRUE;
+#else
+    g_ParserBench.Flash = FALSE;
+#endif
+} /* End f_Parser_Benchmark */
+#endif
 
 
 
 /*
-** f_rcv_char
-** Receive a single character */
-void f_rcv_char( char *InputBuffer )
+** f_Deadline_Set
+** Deadline Timeout_us from now on the IPC counter.
+** The counter is 64 bits at SYSCLK, so deadlines never wrap */
+DEADLINE_TYPE f_Deadline_Set( Uint32 Timeout_us )
 {
-    InputBuffer[0] = ScibRegs.SCIRXBUF.bit.SAR;
-} /* End f_xmit_char */
+    return( ReadIpcTimer() + (Uint64)Timeout_us*IPC_TICKS_PER_US );
+} /* End f_Deadline_Set */
+
+
 
+/*
+** f_Deadline_Expired
+** TRUE once the IPC counter has reached Deadline */
+bool f_Deadline_Expired( DEADLINE_TYPE Deadline )
+{
+    return( ReadIpcTimer() >= Deadline );
+} /* End f_Deadline_Expired */
+
+
+#if COMEX_PKT_EULER_F32_TS
+/*
+** f_UnpackInt_u32
+** This code converts the 4 x 8 bit characters (sent from IMU)
+** into a 32 bit unsigned integer, sent BE */
+void f_UnpackInt_u32( unsigned char *Packet, Uint32 *Output )
+{
+  *Output = ((Uint32)Packet[0] << 24) | ((Uint32)Packet[1] << 16) |
+            ((Uint32)Packet[2] << 8)  |  (Uint32)Packet[3];
+}
+#endif
@@ -9,6 +9,11 @@
 #include "COMEX_Proj.h"
 
 
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+#pragma DATA_SECTION(g_BootTimes, "ComexTrace");
+BOOT_TIMES_TYPE g_BootTimes;
+#endif
+
 
 
 /*
@@ -17,21 +22,41 @@
 **  Initializations */
 void f_Initialize( void )
 {
+#ifdef CPU1
+   Uint16 Id;
+#endif
+
+#if COMEX_INSTRUMENT >= INSTR_TIMING
+   memset( &g_BootTimes, 0, sizeof(BOOT_TIMES_TYPE) );
+#endif
+
    /* Initialize System Control:
    ** PLL, WatchDog, enable Peripheral Clocks */
+#if COMEX_CLOCK_PROFILE == CLOCK_PROFILE_MINIMAL
+   f_InitSysCtrl_Minimal();
+#else
    InitSysCtrl();
+#endif
 
-   /* Initialize GPIO */
+   /* Hot code and CLA images into LS RAM, LS ownership. First,
+   ** f_BootStage reads the IPC counter from hot code */
+   f_MemCfg_Init();
+   f_BootStage( BOOT_STAGE_SYSCTRL );
+   f_SciPort_Init();
+
+#ifdef CPU1
+   /* Initialize GPIO
+   ** The GPIO mux is only accessible from CPU1 */
    InitGpio();
 
 
-   /* Initialize the pins for the SCI-A port.
-   ** GPIO_SetupPinMux() - Sets the GPxMUX1/2 and GPyMUX1/2 register bits
-   ** GPIO_SetupPinOptions() - Sets the direction and configuration of the GPIOS */
-   GPIO_SetupPinMux(18, GPIO_MUX_CPU1, 2); // set to mux 2
-   GPIO_SetupPinOptions(18, GPIO_INPUT, GPIO_PUSHPULL);
-   GPIO_SetupPinMux(19, GPIO_MUX_CPU1, 2); // set to mux 2
-   GPIO_SetupPinOptions(19, GPIO_OUTPUT, GPIO_ASYNC);
+   /* Initialize the pins of every SCI port in use */
+   for( Id=0; Id<SCI_NPORTS; Id++ )
+   {
+       if( COMEX_SCI_PORTS & (1 << Id) ) { f_SciPort_Pins( &g_SciPorts[Id], GPIO_MUX_CPU1 ); }
+   }
+#endif
+   f_BootStage( BOOT_STAGE_GPIO );
 
    /* Clear all __interrupts and initialize PIE vector table:
    ** Disable CPU __interrupts */
@@ -49,66 +74,184 @@ void f_Initialize( void )
    ** Service Routines (ISR).
    ** This will populate the entire table, even if the __interrupt is not used */
    InitPieVectTable();
+   f_BootStage( BOOT_STAGE_PIE );
+
+   /* Packet blocks, before any interrupt can take one */
+   f_PktPool_Init();
+#if COMEX_USE_FEC
+   f_Fec_Init();
+#endif
 
 } /* End f_Initialize */
 
 
+
 /*
-** f_sci_init
-** Test 1,SCIA  DLB, 8-bit word, baud rate 0x000F,
-**   default, 1 STOP bit, no parity */
-void f_sci_init()
+** f_InitSysCtrl_Minimal
+** InitSysCtrl for the minimal clock profile: the same watchdog,
+** flash and PLL set up, but the ADC reference trim is skipped
+** (no ADC is used, and the boot ROM has already run Device_cal)
+** and only the peripherals the build uses get a clock */
+void f_InitSysCtrl_Minimal( void )
 {
-    // Note: Clocks were turned on to the SCIA peripheral in the InitSysCtrl() function
-    ScibRegs.SCICCR.all  = 0x0007;  // 1 stop bit,  No loopback, No parity, 8 char bits, async mode, idle-line protocol
-    ScibRegs.SCICTL1.all = 0x0003;  // enable TX, RX, internal SCICLK, Disable RX ERR, SLEEP, TXWAKE
+    DisableDog();
 
-    ScibRegs.SCICTL2.all = 0x0003;       // Disable txrdy and rxrdy interupt
-    ScibRegs.SCICTL2.bit.TXINTENA = 1;   // redundant of above
-    ScibRegs.SCICTL2.bit.RXBKINTENA = 1; // redundant of above
+#ifdef _FLASH
+    /* InitFlash must run from RAM (see InitSysCtrl) */
+    memcpy( &RamfuncsRunStart, &RamfuncsLoadStart, (size_t)&RamfuncsLoadSize );
+    InitFlash();
+#endif
 
-    // SCIA at 9600 baud
-    // BAUD = clk / (( BRR+1)*8)
-    // @LSPCLK = 50 MHz (200 MHz SYSCLK) HBAUD = 0x02 and LBAUD = 0x8B.
-    // @LSPCLK = 30 MHz (120 MHz SYSCLK) HBAUD = 0x01 and LBAUD = 0x86.
+#ifdef CPU1
+    EALLOW;
+    GPIO_EnableUnbondedIOPullups();
+    EDIS;
 
-    //ScibRegs.SCILBAUD.all = 0x0000; // 115200
-    //ScibRegs.SCILBAUD.all = 0x0036;
+#ifdef _LAUNCHXL_F28379D
+    InitSysPll( XTAL_OSC, IMULT_40, FMULT_0, PLLCLK_BY_2 );
+#else
+    InitSysPll( XTAL_OSC, IMULT_20, FMULT_0, PLLCLK_BY_2 );
+#endif
+#endif
 
-    //ScibRegs.SCIHBAUD.all = 0x0002; //9600
-    //ScibRegs.SCILBAUD.all = 0x008B;
+    f_InitPeripheralClocks_Minimal();
+} /* End f_InitSysCtrl_Minimal */
 
-    ScibRegs.SCIHBAUD.all = 0x0001; //9600 - 25 MHz
-    ScibRegs.SCILBAUD.all = 0x0044;
 
-    /* We set the baud rate low for auto-baud detection */
-    //ScibRegs.SCIHBAUD.all = 0x0000; //for Auto baud
-    //ScibRegs.SCILBAUD.all = 0x0002;
 
-    ScibRegs.SCICTL1.all  = 0x0023;  // Relinquish SCI from SW Reset
-} /* End of f_sci_init */
+/*
+** f_InitPeripheralClocks_Minimal
+** Clock only what the configured features use.
+** Anything added to the firmware that needs a peripheral
+** must enable its clock here too */
+void f_InitPeripheralClocks_Minimal( void )
+{
+    DisablePeripheralClocks();
+
+    EALLOW;
+#if COMEX_USE_PWM_SYNC
+    CpuSysRegs.PCLKCR2.bit.EPWM1     = 1;   // Executive tick
+    CpuSysRegs.PCLKCR2.bit.EPWM2     = 1;   // IMU request trigger
+#else
+    CpuSysRegs.PCLKCR0.bit.CPUTIMER0 = 1;   // Executive tick
+#endif
+#if COMEX_USE_CLA_POST
+    CpuSysRegs.PCLKCR0.bit.CLA1      = 1;   // Attitude post-processing
+#endif
+    CpuSysRegs.PCLKCR7.all          |= COMEX_SCI_PORTS;  // SCI ports, bit n is SCI n
+    EDIS;
+} /* End f_InitPeripheralClocks_Minimal */
 
 
 
+#if COMEX_INSTRUMENT >= INSTR_TIMING
 /*
-** f_fifo_init
-** Initialize the SCI FIFO */
-void f_fifo_init()
+** f_BootStage
+** Stamp the end of a boot stage. The IPC counter runs from
+** reset, at OSCCLK until InitSysPll switches to the PLL, so the
+** SysCtrl stage reads somewhat short */
+void f_BootStage( Uint16 Stage )
 {
-    ScibRegs.SCIFFTX.all = 0xE043; // resume transmit/recieve, fifo enhancements enabled, re-enable transmit fifo, clear TXFFINT
-    //ScibRegs.SCIFFTX.all = 0xE040; // resume transmit/recieve, fifo enhancements enabled, re-enable transmit fifo, clear TXFFINT
-    ScibRegs.SCIFFRX.all = 0x2044; // re-enable fifo revieve, set interupt lvl (4), set rx interupt at gteq to interupt lvl
-    ScibRegs.SCIFFRX.bit.RXFFINTCLR = 1; // clear interupt
-    ScibRegs.SCIFFTX.bit.TXFFINTCLR = 1; // clear interupt
+    if( Stage < BOOT_NSTAGES )
+    {
+        g_BootTimes.Stamp[Stage] = (Uint32)ReadIpcTimer();
+    }
+} /* End f_BootStage */
 
-    /* Auto-baud register will be set in f_Handshake */
-    //ScibRegs.SCIFFCT.all = 0x0;    // clear fifo control registers (flags), disable auto-baud alignment, set fifo transfer delay to 3 baud cycles
-    //ScibRegs.SCIFFCT.all = 0x6003;   // clear ABD flag, enable auto baud, set fifo delat to 3 baud cycles
-    //ScibRegs.SCIFFCT.all = 0x6000;   // clear ABD flag, enable auto baud, no fifo delay
-    ScibRegs.SCIFFCT.all = 0x4000;   // clear ABD flag, disable auto baud, no fifo delay
-} /* End of f_fifo_init */
 
 
+/*
+** f_BootReport
+** Turn the stage stamps into durations (us), once the first
+** sample is in. Stages which never ran (e.g. no handshake)
+** are reported as 0 and don't split the following stage */
+void f_BootReport( void )
+{
+    Uint16 i;
+    Uint32 Prev = 0;
+
+    for( i=0; i<BOOT_NSTAGES; i++ )
+    {
+        if( g_BootTimes.Stamp[i] == 0 ) { g_BootTimes.Stage_us[i] = 0; continue; }
+        g_BootTimes.Stage_us[i] = (g_BootTimes.Stamp[i] - Prev) / IPC_TICKS_PER_US;
+        Prev = g_BootTimes.Stamp[i];
+    }
+    g_BootTimes.Total_us = Prev / IPC_TICKS_PER_US;
+    g_BootTimes.Profile  = COMEX_CLOCK_PROFILE;
+} /* End f_BootReport */
+#endif
+
+
+
+/*
+** f_LsOwner
+** Give LS block Block to the CPU, or to the CLA as data or program.
+** Call under EALLOW */
+static void f_LsOwner( Uint16 Block, Uint16 Owner )
+{
+    Uint32 Bit = 1UL << (2*Block);
+
+    /* MSEL: 2 bits per block, CLAPGM: 1 bit per block */
+    if( Owner == LS_CPU ) { MemCfgRegs.LSxMSEL.all &= ~(3UL*Bit); }
+    else                  { MemCfgRegs.LSxMSEL.all  = (MemCfgRegs.LSxMSEL.all & ~(3UL*Bit)) | Bit; }
+
+    if( Owner == LS_CLA_PROG ) { MemCfgRegs.LSxCLAPGM.all |=  (1UL << Block); }
+    else                       { MemCfgRegs.LSxCLAPGM.all &= ~(1UL << Block); }
+} /* End f_LsOwner */
+
+
+
+/*
+** f_MemCfg_Init
+** Copy the sections which are loaded in flash but run from
+** LS RAM (flash build only), then give each LS block to its
+** owner (LSx_OWNER). The copies must come first: once a block
+** belongs to the CLA the CPU can no longer write it */
+void f_MemCfg_Init( void )
+{
+#ifdef _FLASH
+    memcpy( &HotCodeRunStart,   &HotCodeLoadStart,   (size_t)&HotCodeLoadSize );
+    memcpy( &Cla1ProgRunStart,  &Cla1ProgLoadStart,  (size_t)&Cla1ProgLoadSize );
+    memcpy( &Cla1ConstRunStart, &Cla1ConstLoadStart, (size_t)&Cla1ConstLoadSize );
+#endif
+
+    EALLOW;
+    f_LsOwner( 1, LS1_OWNER );
+    f_LsOwner( 2, LS2_OWNER );
+    f_LsOwner( 3, LS3_OWNER );
+    f_LsOwner( 4, LS4_OWNER );
+    EDIS;
+} /* End f_MemCfg_Init */
+
+
+#ifdef CPU1
+/*
+** f_GiveImuToCpu2
+** Hand the link ports (COMEX_LINK_PORTS) and their pins over to
+** CPU2, then raise IPC_FLAG_BOOT_SYNC. CPU2 waits for the flag
+** before it touches them; it stays up until CPU2 has seen it,
+** however late CPU2 starts, so there is nothing to wait for here */
+void f_GiveImuToCpu2( void )
+{
+   Uint16 Id;
+
+   /* Register access and interrupts go to CPU2.
+   ** Bit n of CPUSEL5 is SCI n, as for COMEX_LINK_PORTS */
+   EALLOW;
+   DevCfgRegs.CPUSEL5.all |= COMEX_LINK_PORTS;
+   EDIS;
+
+   for( Id=0; Id<SCI_NPORTS; Id++ )
+   {
+       if( COMEX_LINK_PORTS & (1 << Id) ) { f_SciPort_Pins( &g_SciPorts[Id], GPIO_MUX_CPU2 ); }
+   }
+
+   SendIpcFlag( IPC_FLAG_BOOT_SYNC );
+} /* End f_GiveImuToCpu2 */
+#endif
+
+
+#if COMEX_USE_HANDSHAKE
 /* f_Hnadshake
 ** This is not currently used!
 ** The Handshake code uses the auto-baud rate detection
@@ -128,10 +271,13 @@ void f_fifo_init()
 **      reply from the IMU will not be the confirmation character. If this is
 **      the case, we must retry the baud lock sequence (return to step 1)
 **      If handshake complete successfully, we need to toggle several registers to
-**      deactivate the auto-baud detection. */
-void f_Handshake( IMU_STATE_TYPE g_IMU_state )
+**      deactivate the auto-baud detection.
+** Runs on Port. Gives up after Timeout_us with auto-baud detection switched
+** off again. Returns IO_OK once locked, else IO_TIMEOUT */
+Uint16 f_Handshake( SCI_PORT_TYPE *Port, IMU_STATE_TYPE g_IMU_state, Uint32 Timeout_us )
 {
     int i;
+    DEADLINE_TYPE Deadline = f_Deadline_Set( Timeout_us );
 
     /* NOTE:
     **   ASCII 'A' :: DEC:65 HEX:0x41
@@ -155,8 +301,8 @@ void f_Handshake( IMU_STATE_TYPE g_IMU_state )
     memset( &InputBuffer, 0, sizeof(char)*50 );
 
     /* Prepare for Auto-Baud Detection */
-    ScibRegs.SCIFFCT.bit.ABDCLR = 1; /* Clear ABD bit */
-    ScibRegs.SCIFFCT.bit.CDC    = 1; /* Enable Auto-Baud detection */
+    Port->Regs->SCIFFCT.bit.ABDCLR = 1; /* Clear ABD bit */
+    Port->Regs->SCIFFCT.bit.CDC    = 1; /* Enable Auto-Baud detection */
 
 
 
@@ -165,56 +311,61 @@ void f_Handshake( IMU_STATE_TYPE g_IMU_state )
     ** until there is a lock */
     while( g_IMU_state.BaudLock==FALSE )
     {
+        if( f_Deadline_Expired( Deadline ) ) { break; }
+
         /* Clear Rx Buffer (active low) */
-        //ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
-        //ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+        //Port->Regs->SCIFFRX.bit.RXFIFORESET = 0;
+        //Port->Regs->SCIFFRX.bit.RXFIFORESET = 1;
 
         /* Clear Tx Buffer (active low) */
-        //ScibRegs.SCIFFTX.bit.TXFIFORESET = 0;
-        //ScibRegs.SCIFFTX.bit.TXFIFORESET = 1;
+        //Port->Regs->SCIFFTX.bit.TXFIFORESET = 0;
+        //Port->Regs->SCIFFTX.bit.TXFIFORESET = 1;
 
         /* 1) Initiate the handshake
         ** 2) Wait for IMU to respond with baud-lock char */
-        while( ScibRegs.SCIFFCT.bit.ABD==0 )
+        while( Port->Regs->SCIFFCT.bit.ABD==0 )
         {
-            f_xmit_char( InitHandshakeChar );
-            if( ScibRegs.SCIFFTX.bit.TXFFST==16 )
+            if( f_Deadline_Expired( Deadline ) ) { break; }
+
+            f_xmit_char( Port, InitHandshakeChar );
+            if( Port->Regs->SCIFFTX.bit.TXFFST==16 )
             {
                 /* Clear Tx Buffer (active low) */
-                ScibRegs.SCIFFTX.bit.TXFIFORESET = 0;
-                ScibRegs.SCIFFTX.bit.TXFIFORESET = 1;
+                Port->Regs->SCIFFTX.bit.TXFIFORESET = 0;
+                Port->Regs->SCIFFTX.bit.TXFIFORESET = 1;
             }
 
-            if( (ScibRegs.SCIFFRX.bit.RXFFOVF==1) )
+            if( (Port->Regs->SCIFFRX.bit.RXFFOVF==1) )
             {
-                ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
-                ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+                Port->Regs->SCIFFRX.bit.RXFIFORESET = 0;
+                Port->Regs->SCIFFRX.bit.RXFIFORESET = 1;
             }
         }
+        if( Port->Regs->SCIFFCT.bit.ABD==0 ) { break; }
 
-        ScibRegs.SCIFFCT.bit.ABDCLR = 1; // Clear ABD bit
-        ScibRegs.SCIFFCT.bit.CDC    = 0; // disable further Auto baud detection
+        Port->Regs->SCIFFCT.bit.ABDCLR = 1; // Clear ABD bit
+        Port->Regs->SCIFFCT.bit.CDC    = 0; // disable further Auto baud detection
 
         /* Clear Rx Buffer (active low) */
-        //ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
-        //ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+        //Port->Regs->SCIFFRX.bit.RXFIFORESET = 0;
+        //Port->Regs->SCIFFRX.bit.RXFIFORESET = 1;
 
         /* Clear Tx Buffer (active low) */
-        //ScibRegs.SCIFFTX.bit.TXFIFORESET = 0;
-        //ScibRegs.SCIFFTX.bit.TXFIFORESET = 1;
+        //Port->Regs->SCIFFTX.bit.TXFIFORESET = 0;
+        //Port->Regs->SCIFFTX.bit.TXFIFORESET = 1;
 
 
         /* 3) Baud rate detected and set
         **    Send IMU Confirmation char */
-        f_xmit_char( ConfirmChar );
+        f_xmit_char( Port, ConfirmChar );
 
         /* 4) Wait for IMU to reply
         **    If reply is confirmation char: Handshake successful
         **    Else: Handshake fail. Send FailChar to IMU and retry
         **    NOTE:  nBytesIn should be 1! */
-        while( ScibRegs.SCIFFRX.bit.RXFFST == 0 ) {}
-        nBytesIn = ScibRegs.SCIFFRX.bit.RXFFST;
-        for( i=0; i<nBytesIn; i++ ) { f_rcv_char( &InputBuffer[i] ); }
+        if( f_WaitRxFifo( Port, Deadline ) != IO_OK ) { break; }
+        nBytesIn = Port->Regs->SCIFFRX.bit.RXFFST;
+        for( i=0; i<nBytesIn; i++ ) { f_rcv_char( Port, &InputBuffer[i] ); }
 
         if( InputBuffer[0]==ConfirmChar )
         {
@@ -223,12 +374,12 @@ void f_Handshake( IMU_STATE_TYPE g_IMU_state )
             ** Set state flags */
             g_IMU_state.BaudLock = TRUE;
 
-            //ScibRegs.SCIFFCT.bit.ABDCLR = 1; // Clear ABD bit
-            //ScibRegs.SCIFFCT.bit.CDC    = 0; // disable further Auto baud detection
+            //Port->Regs->SCIFFCT.bit.ABDCLR = 1; // Clear ABD bit
+            //Port->Regs->SCIFFCT.bit.CDC    = 0; // disable further Auto baud detection
 
             /* Clear/Reset FIFO RX buffer */
-            ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
-            ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+            Port->Regs->SCIFFRX.bit.RXFIFORESET = 0;
+            Port->Regs->SCIFFRX.bit.RXFIFORESET = 1;
         }
         else
         {
@@ -242,16 +393,16 @@ void f_Handshake( IMU_STATE_TYPE g_IMU_state )
                 for(;;)
                 {
                     /* Clear input buffer */
-                    //ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
-                    //ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+                    //Port->Regs->SCIFFRX.bit.RXFIFORESET = 0;
+                    //Port->Regs->SCIFFRX.bit.RXFIFORESET = 1;
 
                     /* Send Confirmation Char */
-                    f_xmit_char( ConfirmChar );
+                    f_xmit_char( Port, ConfirmChar );
 
                     /* Read Reply */
-                    while( ScibRegs.SCIFFRX.bit.RXFFST == 0 ) {}
-                    nBytesIn = ScibRegs.SCIFFRX.bit.RXFFST;
-                    for( i=0; i<nBytesIn; i++ ) { f_rcv_char( &InputBuffer[i] ); }
+                    if( f_WaitRxFifo( Port, Deadline ) != IO_OK ) { break; }
+                    nBytesIn = Port->Regs->SCIFFRX.bit.RXFFST;
+                    for( i=0; i<nBytesIn; i++ ) { f_rcv_char( Port, &InputBuffer[i] ); }
 
                     if( InputBuffer[0]==ConfirmChar )
                     {
@@ -264,8 +415,8 @@ void f_Handshake( IMU_STATE_TYPE g_IMU_state )
 
                 if( g_IMU_state.BaudLock == TRUE ){
                     /* Clear/Reset FIFO RX buffer */
-                    ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
-                    ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+                    Port->Regs->SCIFFRX.bit.RXFIFORESET = 0;
+                    Port->Regs->SCIFFRX.bit.RXFIFORESET = 1;
                 }
                 else
                 {
@@ -274,15 +425,15 @@ void f_Handshake( IMU_STATE_TYPE g_IMU_state )
                     g_IMU_state.BaudLock = FALSE; /* Redundancy for clairity */
 
                     /* Clear/Reset FIFO RX buffer */
-                    ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
-                    ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+                    Port->Regs->SCIFFRX.bit.RXFIFORESET = 0;
+                    Port->Regs->SCIFFRX.bit.RXFIFORESET = 1;
 
                     /* Clear ABD bit */
-                    ScibRegs.SCIFFCT.bit.ABDCLR = 1;
+                    Port->Regs->SCIFFCT.bit.ABDCLR = 1;
 
                     /* Ensure have the auto-baud bit set
                     ** This should be redundant */
-                    ScibRegs.SCIFFCT.bit.CDC    = 1;
+                    Port->Regs->SCIFFCT.bit.CDC    = 1;
                 }
             }
             else
@@ -292,17 +443,28 @@ void f_Handshake( IMU_STATE_TYPE g_IMU_state )
                 g_IMU_state.BaudLock = FALSE; /* Redundancy for clairity */
 
                 /* Clear/Reset FIFO RX buffer */
-                ScibRegs.SCIFFRX.bit.RXFIFORESET = 0;
-                ScibRegs.SCIFFRX.bit.RXFIFORESET = 1;
+                Port->Regs->SCIFFRX.bit.RXFIFORESET = 0;
+                Port->Regs->SCIFFRX.bit.RXFIFORESET = 1;
 
                 /* Clear ABD bit */
-                ScibRegs.SCIFFCT.bit.ABDCLR = 1;
+                Port->Regs->SCIFFCT.bit.ABDCLR = 1;
 
                 /* Ensure have the auto-baud bit set */
-                ScibRegs.SCIFFCT.bit.CDC    = 1;
+                Port->Regs->SCIFFCT.bit.CDC    = 1;
             }
         }
     }
+
+    if( g_IMU_state.BaudLock==FALSE )
+    {
+        /* Timed out: leave the SCI at its configured baud */
+        Port->Regs->SCIFFCT.bit.ABDCLR = 1;
+        Port->Regs->SCIFFCT.bit.CDC    = 0;
+        return( IO_TIMEOUT );
+    }
+
+    return( IO_OK );
 } /* End f_Handshake */
+#endif
 
 
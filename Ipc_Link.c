@@ -0,0 +1,297 @@
+/*
+ * Ipc_Link.c
+ *
+ *  Hand off of decoded IMU samples between the two C28x cores.
+ *  The core which owns the IMU port (CPU2 when COMEX_IMU_ON_CPU2 is set)
+ *  publishes into an attitude snapshot at the start of its send
+ *  message RAM, the other core reads it from its receive message
+ *  RAM. Neither side ever blocks on the other.
+ *
+ *  Every sample also goes into a mailbox ring behind the snapshot,
+ *  committed in batches so the consumer sees one flag per batch.
+ *  A batch is IPC_MBX_BATCH records, or less when the link goes
+ *  idle or the oldest record has waited IPC_MBX_FLUSH_US
+ *  (f_IpcMbx_Poll). The consumer logs the stream (f_IpcMbx_Log).
+ */
+
+#include "COMEX_Proj.h"
+
+/* The layout has to fit this CPU's send message RAM, or the mailbox
+** runs on into RAM the producer can't write. A negative array size
+** here: make IPC_MBX_DEPTH smaller */
+typedef char IPC_MSG_RAM_FITS[(sizeof(IPC_MSG_RAM_TYPE) <= MSG_RAM_SIZE) ? 1 : -1];
+
+#pragma DATA_SECTION(g_IpcLinkStats, "ComexTrace");
+IPC_LINK_STATS_TYPE g_IpcLinkStats;
+
+#if defined(CPU1) && COMEX_IMU_ON_CPU2
+IPC_LOG_TYPE g_IpcLog;
+#endif
+
+/* Producer head not yet made visible to the consumer, and the
+** IPC counter when the oldest record behind it was queued */
+static Uint16 s_MbxHead;
+static Uint64 s_MbxOldest;
+
+/* Consumer: committed records left over from the last drain */
+static Uint16 s_MbxMore;
+
+
+
+/*
+** f_IpcLink_Init
+** Clear the local link statistics and our half of the
+** message RAM (only the owning CPU may write it) */
+void f_IpcLink_Init( void )
+{
+    memset( &g_IpcLinkStats, 0, sizeof(IPC_LINK_STATS_TYPE) );
+    f_Snapshot_Init( IPC_SEND_SNAPSHOT );
+
+    s_MbxHead = 0;
+    s_MbxMore = FALSE;
+    IPC_SEND_RAM->MbxHead = 0;
+    IPC_SEND_RAM->MbxTail = 0;
+} /* End f_IpcLink_Init */
+
+
+
+/*
+** f_IpcLink_Publish
+** Publish a decoded sample to the remote CPU.
+** The snapshot is always updated, IPC_FLAG_SAMPLE is only a
+** "something new" notification and is left alone if the
+** remote has not acknowledged the previous one yet */
+void f_IpcLink_Publish( DATA_TYPE *Data, Uint16 ErrorCount )
+{
+    ATT_SAMPLE_TYPE Rec;
+
+    f_Snapshot_Publish( IPC_SEND_SNAPSHOT, Data, ErrorCount );
+    g_IpcLinkStats.Published++;
+
+    /* Every sample also goes to the mailbox stream */
+    Rec.Seq        = g_IpcLinkStats.Published;
+    Rec.ErrorCount = ErrorCount;
+    Rec.Stamp      = ReadIpcTimer();
+    Rec.Data       = *Data;
+    f_IpcMbx_Put( &Rec );
+
+    if( (IpcRegs.IPCFLG.all & (1UL << IPC_FLAG_SAMPLE)) == 0 )
+    {
+        SendIpcFlag( IPC_FLAG_SAMPLE );
+    }
+} /* End f_IpcLink_Publish */
+
+
+
+/*
+** f_IpcLink_Receive
+** Poll for a sample published by the remote CPU.
+** Returns TRUE if a new, consistent sample was copied into Sample */
+bool f_IpcLink_Receive( ATT_SAMPLE_TYPE *Sample )
+{
+    Uint16 Attempts;
+
+    if( (IpcRegs.IPCSTS.all & (1UL << IPC_FLAG_SAMPLE)) == 0 )
+    {
+        return( FALSE );
+    }
+
+    /* Ack first: a publish from here on raises the flag again */
+    AckIpcFlag( IPC_FLAG_SAMPLE );
+
+    Attempts = f_Snapshot_Read( IPC_RECV_SNAPSHOT, Sample );
+    if( Attempts == 0 )
+    {
+        g_IpcLinkStats.Failed++;
+        return( FALSE );
+    }
+    if( Attempts > 1 ) { g_IpcLinkStats.Retries++; }
+
+    if( Sample->Seq == g_IpcLinkStats.LastSeq ) { return( FALSE ); }
+
+    /* Samples the publisher overwrote before we got to them */
+    if( g_IpcLinkStats.Received != 0 )
+    {
+        g_IpcLinkStats.Missed += Sample->Seq - g_IpcLinkStats.LastSeq - 1;
+    }
+    g_IpcLinkStats.LastSeq = Sample->Seq;
+    g_IpcLinkStats.Received++;
+
+    return( TRUE );
+} /* End f_IpcLink_Receive */
+
+
+
+/*
+** f_IpcMbx_Put
+** Queue one record in the mailbox (producer side).
+** The record is not visible to the consumer until the batch is
+** committed, which happens every IPC_MBX_BATCH records, on
+** f_IpcMbx_Flush or from f_IpcMbx_Poll.
+** Returns FALSE if the ring is full (the record is dropped) */
+bool f_IpcMbx_Put( ATT_SAMPLE_TYPE *Rec )
+{
+    Uint16 Tail = IPC_RECV_RAM->MbxTail;
+
+    if( (Uint16)(s_MbxHead - Tail) >= IPC_MBX_DEPTH )
+    {
+        g_IpcLinkStats.MbxFull++;
+        return( FALSE );
+    }
+
+    if( s_MbxHead == IPC_SEND_RAM->MbxHead ) { s_MbxOldest = ReadIpcTimer(); }
+
+    memcpy( (void *)&IPC_SEND_RAM->MbxRec[s_MbxHead & (IPC_MBX_DEPTH-1)], Rec, sizeof(ATT_SAMPLE_TYPE) );
+    s_MbxHead++;
+    g_IpcLinkStats.MbxPut++;
+
+    if( (Uint16)(s_MbxHead - IPC_SEND_RAM->MbxHead) >= IPC_MBX_BATCH )
+    {
+        f_IpcMbx_Flush();
+    }
+
+    return( TRUE );
+} /* End f_IpcMbx_Put */
+
+
+
+/*
+** f_IpcMbx_Flush
+** Commit every queued record and notify the consumer.
+** The records are written before Head moves, so the consumer
+** never sees a slot it could read half written */
+void f_IpcMbx_Flush( void )
+{
+    if( s_MbxHead == IPC_SEND_RAM->MbxHead ) { return; }
+
+    IPC_SEND_RAM->MbxHead = s_MbxHead;
+    g_IpcLinkStats.MbxBatches++;
+
+    /* A pending flag already covers this batch */
+    if( (IpcRegs.IPCFLG.all & (1UL << IPC_FLAG_MBX)) == 0 )
+    {
+        SendIpcFlag( IPC_FLAG_MBX );
+    }
+} /* End f_IpcMbx_Flush */
+
+
+
+/*
+** f_IpcMbx_Poll
+** Commit a short batch (producer side) when the link is Idle (no
+** sample this pass) or the oldest queued record has waited
+** IPC_MBX_FLUSH_US, so a slow or stalled stream still reaches the
+** consumer. Call once per pass of the link loop */
+void f_IpcMbx_Poll( bool Idle )
+{
+    if( s_MbxHead == IPC_SEND_RAM->MbxHead ) { return; }
+
+    if( Idle || (ReadIpcTimer() - s_MbxOldest >= (Uint64)IPC_MBX_FLUSH_US*IPC_TICKS_PER_US) )
+    {
+        g_IpcLinkStats.MbxTimed++;
+        f_IpcMbx_Flush();
+    }
+} /* End f_IpcMbx_Poll */
+
+
+
+/*
+** f_IpcMbx_Get
+** Drain up to MaxRecs committed records from the remote mailbox
+** (consumer side). Message RAM is only looked at once the
+** producer has raised IPC_FLAG_MBX, or when the last drain left
+** records behind. Copies are done in at most two blocks (ring
+** wrap) and the slots are released by moving our Tail once.
+** Returns the number of records copied into Recs */
+Uint16 f_IpcMbx_Get( ATT_SAMPLE_TYPE *Recs, Uint16 MaxRecs )
+{
+    Uint16 Head, Tail, nRecs, nFirst, Slot;
+
+    /* Ack first: a commit from here on raises the flag again */
+    if( (IpcRegs.IPCSTS.all & (1UL << IPC_FLAG_MBX)) != 0 )
+    {
+        AckIpcFlag( IPC_FLAG_MBX );
+    }
+    else if( s_MbxMore == FALSE )
+    {
+        return( 0 );
+    }
+
+    Head  = IPC_RECV_RAM->MbxHead;
+    Tail  = IPC_SEND_RAM->MbxTail;
+    nRecs = (Uint16)(Head - Tail);
+    s_MbxMore = (nRecs > MaxRecs);
+    if( nRecs > MaxRecs ) { nRecs = MaxRecs; }
+    if( nRecs == 0 ) { return( 0 ); }
+
+    Slot   = Tail & (IPC_MBX_DEPTH-1);
+    nFirst = IPC_MBX_DEPTH - Slot;
+    if( nFirst > nRecs ) { nFirst = nRecs; }
+
+    memcpy( Recs, (void *)&IPC_RECV_RAM->MbxRec[Slot], nFirst*sizeof(ATT_SAMPLE_TYPE) );
+    if( nRecs > nFirst )
+    {
+        memcpy( &Recs[nFirst], (void *)&IPC_RECV_RAM->MbxRec[0], (nRecs-nFirst)*sizeof(ATT_SAMPLE_TYPE) );
+    }
+
+    /* Release the slots to the producer */
+    IPC_SEND_RAM->MbxTail = Tail + nRecs;
+    g_IpcLinkStats.MbxGot += nRecs;
+
+    return( nRecs );
+} /* End f_IpcMbx_Get */
+
+
+
+#if defined(CPU1) && COMEX_IMU_ON_CPU2
+/*
+** f_IpcMbx_Log
+** Consume drained mailbox records: keep them in g_IpcLog, count
+** the ones the stream lost (the producer's MbxFull) and how long
+** the oldest took from publish to here */
+void f_IpcMbx_Log( ATT_SAMPLE_TYPE *Recs, Uint16 nRecs )
+{
+    Uint16 i;
+    Uint32 Age_us;
+    Uint64 Now = ReadIpcTimer();
+
+    for( i=0; i<nRecs; i++ )
+    {
+        if( (g_IpcLinkStats.LogSeq != 0) && (Recs[i].Seq != g_IpcLinkStats.LogSeq + 1) )
+        {
+            g_IpcLinkStats.LogGaps += (Uint16)(Recs[i].Seq - g_IpcLinkStats.LogSeq - 1);
+        }
+        g_IpcLinkStats.LogSeq = Recs[i].Seq;
+
+        g_IpcLog.Rec[g_IpcLog.Head & (IPC_LOG_DEPTH-1)] = Recs[i];
+        g_IpcLog.Head++;
+    }
+
+    if( nRecs > 0 )
+    {
+        Age_us = (Uint32)((Now - Recs[0].Stamp) / IPC_TICKS_PER_US);
+        if( Age_us > g_IpcLinkStats.LogAgeMax_us ) { g_IpcLinkStats.LogAgeMax_us = Age_us; }
+    }
+} /* End f_IpcMbx_Log */
+#endif
+
+
+
+/*
+** f_IpcFlag_Wait
+** Wait up to Timeout_us for the other CPU to raise Flag, and
+** acknowledge it. The flag stays raised until we do, so a core
+** which starts late still finds it, and the caller can simply try
+** again. Returns IO_OK or IO_TIMEOUT */
+Uint16 f_IpcFlag_Wait( Uint16 Flag, Uint32 Timeout_us )
+{
+    DEADLINE_TYPE Deadline = f_Deadline_Set( Timeout_us );
+
+    while( (IpcRegs.IPCSTS.all & (1UL << Flag)) == 0 )
+    {
+        if( f_Deadline_Expired( Deadline ) ) { return( IO_TIMEOUT ); }
+    }
+    AckIpcFlag( Flag );
+
+    return( IO_OK );
+} /* End f_IpcFlag_Wait */
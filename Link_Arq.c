@@ -0,0 +1,285 @@
+/*
+ * Link_Arq.c
+ *
+ *  Selective retransmission on the IMU links (COMEX_USE_ARQ).
+ *
+ *  Packet type 6 carries the IMU's packet sequence number, one more
+ *  for every new packet it sends. A packet lost on the line (bad
+ *  checksum, missing bytes) shows as a gap in the numbers once the
+ *  next one is in. The gap is NAKed (ARQ_NAK and the number, in
+ *  place of a request, f_LinkStep) and the IMU sends that packet
+ *  again from its history, while new packets keep coming on the
+ *  other requests.
+ *
+ *  Samples still reach the consumers in order: the frames behind a
+ *  gap wait in the window until it is filled, or given up on after
+ *  ARQ_HOLD_US. A resent sample keeps the time it was due (between
+ *  its neighbours' arrivals), not the time of its second arrival.
+ *  The window holds pool blocks as they came off the RX queue,
+ *  ARQ_WINDOW of them at most.
+ *
+ *  f_Arq_Check (COMEX_INSTRUMENT INSTR_BENCH) runs the window over
+ *  a synthetic link at a few packet loss rates and records goodput
+ *  and the latency ARQ added, with and without it, on target.
+ *  tools/arq_sim.py builds this file on the host and runs the
+ *  check for other window sizes, hold times and loss rates.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#if COMEX_USE_ARQ
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+ARQ_CHECK_TYPE g_ArqCheck;
+#endif
+
+
+
+/*
+** f_Arq_Init
+** Empty window, the first packet in sets the numbering */
+void f_Arq_Init( ARQ_TYPE *A )
+{
+    memset( A, 0, sizeof(ARQ_TYPE) );
+} /* End f_Arq_Init */
+
+
+
+/*
+** f_ArqFar
+** Seq is neither in the window nor just behind it: past the end,
+** or far enough back that the IMU must have started again */
+static bool f_ArqFar( ARQ_TYPE *A, Uint16 Seq )
+{
+    return( ((Uint16)(Seq - A->Expect) >= ARQ_WINDOW) &&
+            ((Uint16)(A->Expect - Seq) > ARQ_WINDOW) );
+} /* End f_ArqFar */
+
+
+
+/*
+** f_Arq_Room
+** FALSE while Seq is too far from the window for f_Arq_Put to
+** take it with frames still held. The caller moves the window on
+** with f_Arq_Get Force (empty, in the end) and asks again */
+bool f_Arq_Room( ARQ_TYPE *A, Uint16 Seq )
+{
+    if( A->Started == FALSE ) { return( TRUE ); }
+    return( (f_ArqFar( A, Seq ) == FALSE) || (A->Expect == A->Next) );
+} /* End f_Arq_Room */
+
+
+
+/*
+** f_Arq_Put
+** A good packet with sequence number Seq, arrived at Stamp (IPC
+** counter). Marks any numbers skipped to get there as gaps.
+** Returns FALSE if the window did not take Block, the caller frees
+** it: a duplicate, a number already given up on, or (f_Arq_Room
+** not asked) beyond the window */
+bool f_Arq_Put( ARQ_TYPE *A, Uint16 Seq, PKT_BLOCK_TYPE *Block, Uint64 Stamp )
+{
+    Uint16 i, s, nGap;
+
+    /* A jump with nothing held: a long outage, or the IMU started
+    ** numbering again. Carry on from here */
+    if( A->Started && (A->Expect == A->Next) && f_ArqFar( A, Seq ) )
+    {
+        if( (Uint16)(Seq - A->Expect) < 0x8000 ) { A->Stats.Lost += Seq - A->Expect; }
+        A->Started = FALSE;
+    }
+
+    if( A->Started == FALSE )
+    {
+        A->Expect    = Seq;
+        A->Next      = Seq;
+        A->LastStamp = Stamp;
+        A->Started   = TRUE;
+    }
+
+    /* Behind the window, or past it */
+    if( (Uint16)(Seq - A->Expect) >= 0x8000 ) { A->Stats.Duplicates++; return( FALSE ); }
+    if( (Uint16)(Seq - A->Expect) >= ARQ_WINDOW ) { return( FALSE ); }
+
+    i = Seq & (ARQ_WINDOW-1);
+
+    if( (Uint16)(Seq - A->Next) < 0x8000 )
+    {
+        /* Newest yet. The ones skipped were due evenly between the
+        ** last arrival and this one */
+        nGap = Seq - A->Next;
+        for( s=0; s<nGap; s++ )
+        {
+            A->Slot[(A->Next + s) & (ARQ_WINDOW-1)]   = 0;
+            A->Naks[(A->Next + s) & (ARQ_WINDOW-1)]   = 0;
+            A->Missed[(A->Next + s) & (ARQ_WINDOW-1)] = Stamp;
+            A->Stamp[(A->Next + s) & (ARQ_WINDOW-1)]  =
+                A->LastStamp + (Stamp - A->LastStamp) * (s + 1) / (nGap + 1);
+        }
+        A->Next      = Seq + 1;
+        A->LastStamp = Stamp;
+        A->Stamp[i]  = Stamp;
+    }
+    else
+    {
+        /* Fills a gap, unless it is one we already have */
+        if( A->Slot[i] != 0 ) { A->Stats.Duplicates++; return( FALSE ); }
+        A->Stats.Recovered++;
+    }
+
+    A->Slot[i] = Block;
+    return( TRUE );
+} /* End f_Arq_Put */
+
+
+
+/*
+** f_Arq_Get
+** Next frame in order, and in *Stamp when its sample was due, or
+** 0 if the next one is a gap still worth waiting for. Gaps older
+** than ARQ_HOLD_US at Now (IPC counter) are given up on. Force
+** gives up on a gap at the head of the window regardless, to make
+** room */
+PKT_BLOCK_TYPE *f_Arq_Get( ARQ_TYPE *A, Uint64 Now, bool Force, Uint64 *Stamp )
+{
+    PKT_BLOCK_TYPE *Block;
+    Uint16 i;
+    Uint32 Added_us;
+    Uint64 Hold = (Uint64)ARQ_HOLD_US*IPC_TICKS_PER_US;
+
+    while( A->Expect != A->Next )
+    {
+        i = A->Expect & (ARQ_WINDOW-1);
+
+        if( A->Slot[i] != 0 )
+        {
+            Block      = A->Slot[i];
+            A->Slot[i] = 0;
+            *Stamp     = A->Stamp[i];
+            A->Expect++;
+
+            Added_us = (Now > A->Stamp[i]) ? (Uint32)((Now - A->Stamp[i]) / IPC_TICKS_PER_US) : 0;
+            A->Stats.AddedSum_us += Added_us;
+            if( Added_us > A->Stats.AddedMax_us ) { A->Stats.AddedMax_us = Added_us; }
+            A->Stats.Delivered++;
+            return( Block );
+        }
+
+        if( (Force == FALSE) && (Now - A->Missed[i] < Hold) ) { return( 0 ); }
+
+        A->Stats.Lost++;
+        A->Expect++;
+        Force = FALSE;
+    }
+
+    return( 0 );
+} /* End f_Arq_Get */
+
+
+
+/*
+** f_Arq_Nak
+** TRUE with the oldest gap still to NAK (fewer than ARQ_MAX_NAKS
+** so far) in *Seq, counted as NAKed */
+bool f_Arq_Nak( ARQ_TYPE *A, Uint16 *Seq )
+{
+    Uint16 s, i;
+
+    for( s=A->Expect; s!=A->Next; s++ )
+    {
+        i = s & (ARQ_WINDOW-1);
+        if( (A->Slot[i] == 0) && (A->Naks[i] < ARQ_MAX_NAKS) )
+        {
+            A->Naks[i]++;
+            A->Stats.Naks++;
+            *Seq = s;
+            return( TRUE );
+        }
+    }
+    return( FALSE );
+} /* End f_Arq_Nak */
+
+
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+/*
+** f_ArqRandom
+** xorshift32, for the packet losses */
+static Uint32 f_ArqRandom( Uint32 *State )
+{
+    Uint32 x = *State;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *State = x;
+    return( x );
+} /* End f_ArqRandom */
+
+
+
+/*
+** f_Arq_Check
+** nPackets new packets over a synthetic link which loses each
+** packet sent, new or resent, with each of the ARQ_CHECK_LOSS
+** probabilities. One request (or NAK) per ARQ_CHECK_SLOT_US of
+** simulated time, so this takes a fraction of that. Goodput is
+** samples delivered per new packet sent; without ARQ it is the
+** packets through first time */
+void f_Arq_Check( Uint16 nPackets )
+{
+    static const Uint32 LossPpm[ARQ_CHECK_NLOSS] = ARQ_CHECK_LOSS;
+    static ARQ_TYPE A;
+    static PKT_BLOCK_TYPE Dummy;     /* Never looked at, only held */
+    Uint16 k, Sent, Seq, Plain;
+    Uint32 Threshold;
+    Uint32 Rand = 0x7F4A7C15UL;
+    Uint64 Now, Stamp;
+
+    memset( &g_ArqCheck, 0, sizeof(ARQ_CHECK_TYPE) );
+
+    for( k=0; k<ARQ_CHECK_NLOSS; k++ )
+    {
+        Threshold = (Uint32)(((Uint64)LossPpm[k] << 32) / 1000000UL);
+        f_Arq_Init( &A );
+        Sent  = 0;
+        Plain = 0;
+        Now   = ReadIpcTimer();
+
+        while( (Sent < nPackets) || (A.Expect != A.Next) )
+        {
+            Now += (Uint64)ARQ_CHECK_SLOT_US*IPC_TICKS_PER_US;
+
+            if( f_Arq_Nak( &A, &Seq ) )
+            {
+                if( f_ArqRandom( &Rand ) >= Threshold ) { f_Arq_Put( &A, Seq, &Dummy, Now ); }
+            }
+            else if( Sent < nPackets )
+            {
+                Seq = Sent++;
+                if( f_ArqRandom( &Rand ) >= Threshold )
+                {
+                    Plain++;
+                    while( f_Arq_Room( &A, Seq ) == FALSE ) { f_Arq_Get( &A, Now, TRUE, &Stamp ); }
+                    f_Arq_Put( &A, Seq, &Dummy, Now );
+                }
+            }
+
+            while( f_Arq_Get( &A, Now, FALSE, &Stamp ) != 0 ) {}
+        }
+
+        g_ArqCheck.LossPpm[k]      = LossPpm[k];
+        g_ArqCheck.PlainGoodput[k] = (float)Plain / nPackets;
+        g_ArqCheck.ArqGoodput[k]   = (float)A.Stats.Delivered / nPackets;
+        g_ArqCheck.Lost[k]         = A.Stats.Lost;
+        g_ArqCheck.Naks[k]         = A.Stats.Naks;
+        g_ArqCheck.AddedMean_us[k] = (A.Stats.Delivered > 0) ? (float)A.Stats.AddedSum_us / A.Stats.Delivered : 0.0f;
+        g_ArqCheck.AddedMax_us[k]  = A.Stats.AddedMax_us;
+    }
+
+    g_ArqCheck.Packets = nPackets;
+} /* End f_Arq_Check */
+#endif
+
+#endif /* COMEX_USE_ARQ */
@@ -0,0 +1,123 @@
+/*
+ * Packet_Pool.c
+ *
+ *  Fixed pool of packet blocks, so packets can be queued for later
+ *  processing without malloc. Blocks are all the same size, so the
+ *  pool can't fragment.
+ *
+ *  Alloc and free are lock free and may be called from the RX ISR
+ *  and from the foreground at the same time. Every block has a
+ *  claim count which only ever changes through __inc/__dec, single
+ *  read-modify-write instructions an interrupt can't split:
+ *    alloc: __inc the count; if it is now 1 the block is ours,
+ *           otherwise someone else holds it, __dec and try the next
+ *    free:  __dec the count
+ *  An ISR runs to completion, so a foreground claim can only ever
+ *  see an ISR claim which has already been settled one way or the
+ *  other. A rotating cursor makes the first probe hit a free block
+ *  in the normal case, the worst case is PKT_POOL_DEPTH probes.
+ *
+ *  The counters in g_PktPoolStats are bumped with __inc as well so
+ *  neither side can lose the other's count. HighWater is only a
+ *  peak and may miss a racing update by one.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#pragma DATA_SECTION(s_PktBlocks, "ComexPool");
+#pragma DATA_SECTION(s_PktClaim, "ComexPool");
+static PKT_BLOCK_TYPE s_PktBlocks[PKT_POOL_DEPTH];
+static volatile int   s_PktClaim[PKT_POOL_DEPTH];
+
+static volatile Uint16 s_PktCursor;   /* Where the next alloc starts looking */
+static volatile int    s_PktInUse;
+
+#pragma DATA_SECTION(g_PktPoolStats, "ComexTrace");
+PKT_POOL_STATS_TYPE g_PktPoolStats;
+
+#pragma CODE_SECTION(f_PktPool_Alloc, "ComexHotCode");
+#pragma CODE_SECTION(f_PktPool_Free, "ComexHotCode");
+
+
+
+/*
+** f_PktPool_Init
+** Return every block to the pool. Not safe against a running
+** RX ISR, call before it is enabled */
+void f_PktPool_Init( void )
+{
+    Uint16 i;
+
+    for( i=0; i<PKT_POOL_DEPTH; i++ ) { s_PktClaim[i] = 0; }
+    s_PktCursor = 0;
+    s_PktInUse  = 0;
+    memset( &g_PktPoolStats, 0, sizeof(PKT_POOL_STATS_TYPE) );
+} /* End f_PktPool_Init */
+
+
+
+/*
+** f_PktPool_Alloc
+** Claim a free block. Returns 0 if the pool is empty */
+PKT_BLOCK_TYPE *f_PktPool_Alloc( void )
+{
+    Uint16 k, i;
+    int InUse;
+
+    i = s_PktCursor;
+    for( k=0; k<PKT_POOL_DEPTH; k++ )
+    {
+        i = (i + 1) & (PKT_POOL_DEPTH-1);
+
+        if( s_PktClaim[i] != 0 ) { continue; }   /* Cheap pre-check */
+
+        __inc( (int *)&s_PktClaim[i] );
+        if( s_PktClaim[i] == 1 )
+        {
+            s_PktCursor = i;
+
+            __inc( (int *)&s_PktInUse );
+            InUse = s_PktInUse;
+            if( InUse > (int)g_PktPoolStats.HighWater ) { g_PktPoolStats.HighWater = InUse; }
+            __inc( (int *)&g_PktPoolStats.Allocs );
+
+            return( &s_PktBlocks[i] );
+        }
+        __dec( (int *)&s_PktClaim[i] );
+    }
+
+    __inc( (int *)&g_PktPoolStats.Empty );
+    return( 0 );
+} /* End f_PktPool_Alloc */
+
+
+
+/*
+** f_PktPool_Free
+** Give a block back. Any context may free a block, whichever
+** context allocated it */
+void f_PktPool_Free( PKT_BLOCK_TYPE *Block )
+{
+    Uint16 i = (Uint16)(Block - &s_PktBlocks[0]);
+
+    if( (i >= PKT_POOL_DEPTH) || (s_PktClaim[i] == 0) )
+    {
+        __inc( (int *)&g_PktPoolStats.BadFree );
+        return;
+    }
+
+    __dec( (int *)&s_PktInUse );
+    __dec( (int *)&s_PktClaim[i] );
+    __inc( (int *)&g_PktPoolStats.Frees );
+} /* End f_PktPool_Free */
+
+
+
+/*
+** f_PktPool_InUse
+** Blocks currently allocated */
+Uint16 f_PktPool_InUse( void )
+{
+    return( (Uint16)s_PktInUse );
+} /* End f_PktPool_InUse */
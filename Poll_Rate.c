@@ -0,0 +1,156 @@
+/*
+ * Poll_Rate.c
+ *
+ *  Request pacing for the IMU links (COMEX_USE_ADAPTIVE_POLL).
+ *
+ *  How fast an IMU can be asked depends on the baud, the packet
+ *  type and the IMU itself, so rather than a fixed rate each link
+ *  measures every round trip (request sent to the last byte of
+ *  the answer, RX ISR stamps) and splits it into the time on the
+ *  wire and the IMU's turnaround. It keeps a smoothed round trip
+ *  and its deviation, the TCP way, and a smoothed turnaround.
+ *
+ *  The request interval follows additive increase, multiplicative
+ *  decrease: every clean answer takes POLL_STEP_US off it, down to
+ *  the last answer's line time plus the smoothed turnaround plus
+ *  POLL_MARGIN_US, which is as fast as one request in flight can
+ *  go. The line time is taken as is, so the floor moves at once
+ *  when the packet type changes. A checksum failure, a timeout or
+ *  an RX overrun on the port doubles it. The link settles just
+ *  under the rate where the errors start, and follows it when the
+ *  baud or packet type changes.
+ *
+ *  The answer timeout is the smoothed round trip plus four
+ *  deviations. The first answer after a timeout may be the late
+ *  answer to the earlier request, so it isn't measured (Karn).
+ */
+
+#include "COMEX_Proj.h"
+
+
+#if COMEX_USE_ADAPTIVE_POLL
+
+/*
+** f_PollPortErrors
+** RX errors of the port which mean we ask faster than it copes */
+static Uint16 f_PollPortErrors( SCI_PORT_TYPE *Port )
+{
+    return( Port->Stats.Overruns + Port->Stats.FifoOverflows );
+} /* End f_PollPortErrors */
+
+
+
+/*
+** f_PollRate_Init
+** Start slow, with the full link timeout, until the first round
+** trips are in */
+void f_PollRate_Init( POLL_RATE_TYPE *P, SCI_PORT_TYPE *Port )
+{
+    memset( P, 0, sizeof(POLL_RATE_TYPE) );
+
+    P->Interval_us = POLL_START_US;
+    P->Rto_us      = LINK_TIMEOUT_US;
+    P->PortErrors  = f_PollPortErrors( Port );
+    P->Stats.IntervalMin_us = POLL_START_US;
+} /* End f_PollRate_Init */
+
+
+
+/*
+** f_PollRate_Due
+** TRUE once the interval since the last request is up */
+bool f_PollRate_Due( POLL_RATE_TYPE *P )
+{
+    return( ReadIpcTimer() - P->Sent >= (Uint64)P->Interval_us*IPC_TICKS_PER_US );
+} /* End f_PollRate_Due */
+
+
+
+/*
+** f_PollRate_Sent
+** A request has just gone out. Returns the timeout for its answer */
+Uint32 f_PollRate_Sent( POLL_RATE_TYPE *P )
+{
+    P->Sent = ReadIpcTimer();
+    return( P->Rto_us );
+} /* End f_PollRate_Sent */
+
+
+
+/*
+** f_PollRate_Answer
+** A good answer: measure it and step the interval down, unless
+** the port dropped bytes meanwhile */
+void f_PollRate_Answer( POLL_RATE_TYPE *P, SCI_PORT_TYPE *Port, DATA_TYPE *Data )
+{
+    Uint16 PortErrors = f_PollPortErrors( Port );
+    Uint32 Rtt_us, Floor_us;
+    int32  Turn_us, Err;
+
+    if( P->Retry )
+    {
+        P->Retry = FALSE;
+        P->Stats.Skipped++;
+    }
+    else if( Data->RxLastStamp > P->Sent )
+    {
+        Rtt_us  = (Uint32)((Data->RxLastStamp - P->Sent) / IPC_TICKS_PER_US);
+        Turn_us = (int32)((int64_t)(Data->RxFirstStamp - P->Sent - (1 + FEC_EXPANSION)*Port->ByteTicks) / IPC_TICKS_PER_US);
+        if( Turn_us < 0 ) { Turn_us = 0; }
+        if( (Uint32)Turn_us > Rtt_us ) { Turn_us = Rtt_us; }
+        P->Line_us = Rtt_us - Turn_us;
+
+        if( P->Stats.Samples == 0 )
+        {
+            P->Srtt_us   = Rtt_us;
+            P->RttVar_us = Rtt_us / 2;
+            P->Turn_us   = Turn_us;
+        }
+        else
+        {
+            Err = (int32)Rtt_us - (int32)P->Srtt_us;
+            P->Srtt_us   = (int32)P->Srtt_us + Err/8;
+            if( Err < 0 ) { Err = -Err; }
+            P->RttVar_us = (int32)P->RttVar_us + (Err - (int32)P->RttVar_us)/4;
+            P->Turn_us   = (int32)P->Turn_us + (Turn_us - (int32)P->Turn_us)/8;
+        }
+        if( Rtt_us > P->Stats.RttMax_us ) { P->Stats.RttMax_us = Rtt_us; }
+        P->Stats.Samples++;
+
+        P->Rto_us = P->Srtt_us + 4*P->RttVar_us;
+        if( P->Rto_us < POLL_RTO_MIN_US ) { P->Rto_us = POLL_RTO_MIN_US; }
+        if( P->Rto_us > LINK_TIMEOUT_US ) { P->Rto_us = LINK_TIMEOUT_US; }
+    }
+
+    if( PortErrors != P->PortErrors )
+    {
+        P->PortErrors = PortErrors;
+        f_PollRate_Error( P, FALSE );
+        return;
+    }
+
+    /* Additive increase, the interval never below one exchange on the wire */
+    Floor_us = P->Line_us + P->Turn_us + POLL_MARGIN_US;
+    if( Floor_us < POLL_MIN_US ) { Floor_us = POLL_MIN_US; }
+    if( P->Interval_us > Floor_us + POLL_STEP_US ) { P->Interval_us -= POLL_STEP_US; }
+    else                                           { P->Interval_us  = Floor_us; }
+
+    if( P->Interval_us < P->Stats.IntervalMin_us ) { P->Stats.IntervalMin_us = P->Interval_us; }
+} /* End f_PollRate_Answer */
+
+
+
+/*
+** f_PollRate_Error
+** Checksum failure, timeout (Timeout TRUE) or RX overrun:
+** multiplicative decrease */
+void f_PollRate_Error( POLL_RATE_TYPE *P, bool Timeout )
+{
+    if( Timeout ) { P->Retry = TRUE; }
+
+    P->Interval_us *= 2;
+    if( P->Interval_us > POLL_MAX_US ) { P->Interval_us = POLL_MAX_US; }
+    P->Stats.Backoffs++;
+} /* End f_PollRate_Error */
+
+#endif /* COMEX_USE_ADAPTIVE_POLL */
@@ -0,0 +1,211 @@
+/*
+ * Pwm_Sync.c
+ *
+ *  IMU requests on the control beat (COMEX_USE_PWM_SYNC).
+ *
+ *  Polled as soon as the last answer is in, or at the adaptive
+ *  rate, the IMU's samples land anywhere in the control period and
+ *  the control update sees them up to a tick old. Here the tick and
+ *  the requests come off one time base instead: ePWM1 counts up
+ *  over EXEC_TICK_US and its zero interrupt is the executive tick
+ *  (f_Exec_Tick, in place of CPU Timer 0). ePWM2 runs the same
+ *  period, synchronised to ePWM1's zero with a phase of the lead,
+ *  so its own zero comes the lead ahead of every tick, and its ISR
+ *  sends the requests the links have armed (f_LinkStep). With the
+ *  lead a round trip and a little over, the answer is framed just
+ *  before the tick, and the link service and control task run on
+ *  it straight away.
+ *
+ *  The lead is PWM_SYNC_LEAD_US, or with that 0 the primary link's
+ *  smoothed round trip (Poll_Rate.c) plus PWM_SYNC_GUARD_US,
+ *  followed by f_PwmSync_Control every control update; a new phase
+ *  takes effect at the next sync. A round trip longer than the tick
+ *  leaves every other trigger skipped, the link still waiting.
+ *
+ *  g_PwmSyncStats keeps the requests sent and skipped, the lead, and
+ *  how old the primary sample is when the control update gets it.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#if COMEX_USE_PWM_SYNC
+
+#if PWM_SYNC_PERIOD > 65536
+#error "EXEC_TICK_US is too long for a 16 bit ePWM period"
+#endif
+#if PWM_SYNC_LEAD_US + PWM_SYNC_LEAD_MIN_US > EXEC_TICK_US
+#error "PWM_SYNC_LEAD_US must leave PWM_SYNC_LEAD_MIN_US of the executive tick"
+#endif
+
+#pragma DATA_SECTION(g_PwmSyncStats, "ComexTrace");
+PWM_SYNC_STATS_TYPE g_PwmSyncStats;
+
+static Uint64 s_PwmSyncLastSample;   /* RxLastStamp of the last sample aged */
+
+__interrupt void f_PwmSyncTickIsr( void );
+__interrupt void f_PwmSyncReqIsr( void );
+
+#pragma CODE_SECTION(f_PwmSyncTickIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_PwmSyncReqIsr, "ComexHotCode");
+
+
+
+/*
+** f_PwmSyncPhase
+** Lead of the request trigger, in TBCLK counts of ePWM2's phase */
+static void f_PwmSyncPhase( Uint32 Lead_us )
+{
+    if( Lead_us < PWM_SYNC_LEAD_MIN_US )                { Lead_us = PWM_SYNC_LEAD_MIN_US; }
+    if( Lead_us > EXEC_TICK_US - PWM_SYNC_LEAD_MIN_US ) { Lead_us = EXEC_TICK_US - PWM_SYNC_LEAD_MIN_US; }
+
+    EPwm2Regs.TBPHS.bit.TBPHS = (Uint16)(Lead_us*PWM_SYNC_TBCLK_MHZ);
+    g_PwmSyncStats.Lead_us    = Lead_us;
+} /* End f_PwmSyncPhase */
+
+
+
+/*
+** f_PwmSync_Init
+** Set up (but don't start) the two time bases and their
+** interrupts. From f_Exec_Init */
+void f_PwmSync_Init( void )
+{
+    memset( &g_PwmSyncStats, 0, sizeof(PWM_SYNC_STATS_TYPE) );
+    s_PwmSyncLastSample = 0;
+
+    /* Time bases held until f_PwmSync_Start, so they start together */
+    EALLOW;
+    CpuSysRegs.PCLKCR0.bit.TBCLKSYNC = 0;
+    EDIS;
+
+    /* ePWM1: the tick. Up count, sync out at zero */
+    EPwm1Regs.TBCTL.bit.CTRMODE   = 3;   // Frozen for now
+    EPwm1Regs.TBPRD               = PWM_SYNC_PERIOD - 1;
+    EPwm1Regs.TBCTR               = 0;
+    EPwm1Regs.TBPHS.bit.TBPHS     = 0;
+    EPwm1Regs.TBCTL.bit.PHSEN     = 0;
+    EPwm1Regs.TBCTL.bit.HSPCLKDIV = 0;   // TBCLK = EPWMCLK
+    EPwm1Regs.TBCTL.bit.CLKDIV    = 0;
+    EPwm1Regs.TBCTL.bit.SYNCOSEL  = 1;   // CTR = 0
+    EPwm1Regs.ETSEL.bit.INTSEL    = 1;   // CTR = 0
+    EPwm1Regs.ETPS.bit.INTPRD     = 1;   // Every event
+    EPwm1Regs.ETCLR.bit.INT       = 1;
+    EPwm1Regs.ETSEL.bit.INTEN     = 1;
+
+    /* ePWM2: the request trigger. Loads the phase at ePWM1's zero,
+    ** so reaches its own zero the lead before ePWM1's next */
+    EPwm2Regs.TBCTL.bit.CTRMODE   = 3;
+    EPwm2Regs.TBPRD               = PWM_SYNC_PERIOD - 1;
+    EPwm2Regs.TBCTL.bit.PHSEN     = 1;
+    EPwm2Regs.TBCTL.bit.PHSDIR    = 1;   // Count up after the sync
+    EPwm2Regs.TBCTL.bit.HSPCLKDIV = 0;
+    EPwm2Regs.TBCTL.bit.CLKDIV    = 0;
+    EPwm2Regs.TBCTL.bit.SYNCOSEL  = 3;   // Sync goes no further
+    EPwm2Regs.ETSEL.bit.INTSEL    = 1;
+    EPwm2Regs.ETPS.bit.INTPRD     = 1;
+    EPwm2Regs.ETCLR.bit.INT       = 1;
+    EPwm2Regs.ETSEL.bit.INTEN     = 1;
+    f_PwmSyncPhase( (PWM_SYNC_LEAD_US > 0) ? PWM_SYNC_LEAD_US : PWM_SYNC_GUARD_US );
+    EPwm2Regs.TBCTR               = EPwm2Regs.TBPHS.bit.TBPHS;
+
+    EALLOW;
+    PieVectTable.EPWM1_INT = &f_PwmSyncTickIsr;
+    PieVectTable.EPWM2_INT = &f_PwmSyncReqIsr;
+    EDIS;
+
+    PieCtrlRegs.PIEIER3.bit.INTx1 = 1;  // ePWM1 is PIE 3.1
+    PieCtrlRegs.PIEIER3.bit.INTx2 = 1;  // ePWM2 is PIE 3.2
+    IER |= M_INT3;
+} /* End f_PwmSync_Init */
+
+
+
+/*
+** f_PwmSync_Start
+** Start both time bases on the same TBCLK edge. From f_Exec_Start */
+void f_PwmSync_Start( void )
+{
+    EPwm1Regs.TBCTL.bit.CTRMODE = 0;   // Up count
+    EPwm2Regs.TBCTL.bit.CTRMODE = 0;
+
+    EALLOW;
+    CpuSysRegs.PCLKCR0.bit.TBCLKSYNC = 1;
+    EDIS;
+} /* End f_PwmSync_Start */
+
+
+
+/*
+** f_PwmSync_Control
+** From the control task at Now (IPC counter): how old the primary
+** sample is, if it is new since the last update, and the lead for
+** the next requests */
+void f_PwmSync_Control( Uint64 Now )
+{
+    LINK_TYPE *Link = &g_Links[g_LinkPrimary];
+    Uint32 Age_us;
+
+    if( (Link->Sample.RxLastStamp != s_PwmSyncLastSample) && (Now > Link->Sample.RxLastStamp) )
+    {
+        s_PwmSyncLastSample = Link->Sample.RxLastStamp;
+        Age_us = (Uint32)((Now - Link->Sample.RxLastStamp) / IPC_TICKS_PER_US);
+
+        g_PwmSyncStats.Fresh++;
+        g_PwmSyncStats.AgeLast_us = Age_us;
+        g_PwmSyncStats.AgeSum_us += Age_us;
+        if( Age_us > g_PwmSyncStats.AgeMax_us ) { g_PwmSyncStats.AgeMax_us = Age_us; }
+    }
+
+#if PWM_SYNC_LEAD_US == 0
+    f_PwmSyncPhase( Link->Poll.Srtt_us + PWM_SYNC_GUARD_US );
+#endif
+} /* End f_PwmSync_Control */
+
+
+
+/*
+** f_PwmSyncTickIsr
+** ePWM1 zero: executive tick */
+__interrupt void f_PwmSyncTickIsr( void )
+{
+    f_Exec_Tick();
+    EPwm1Regs.ETCLR.bit.INT = 1;
+    PieCtrlRegs.PIEACK.all  = PIEACK_GROUP3;
+} /* End f_PwmSyncTickIsr */
+
+
+
+/*
+** f_PwmSyncReqIsr
+** ePWM2 zero, the lead before the tick: send every armed request.
+** A link not armed (still waiting on its last answer) or with its
+** TX still busy misses this beat */
+__interrupt void f_PwmSyncReqIsr( void )
+{
+    Uint16 Id, i;
+    LINK_TYPE *Link;
+
+    for( Id=0; Id<LINK_NPORTS; Id++ )
+    {
+        if( (COMEX_IMU_PORTS & (1 << Id)) == 0 ) { continue; }
+        Link = &g_Links[Id];
+
+        if( (Link->SyncArmed == FALSE) || (Link->Port->Regs->SCICTL2.bit.TXEMPTY == 0) )
+        {
+            g_PwmSyncStats.Skipped++;
+            continue;
+        }
+
+        for( i=0; i<Link->SyncLen; i++ ) { f_xmit_char( Link->Port, Link->SyncReq[i] ); }
+        Link->SyncStamp = ReadIpcTimer();
+        Link->SyncArmed = FALSE;
+        Link->SyncSent++;
+        g_PwmSyncStats.Requests++;
+    }
+
+    EPwm2Regs.ETCLR.bit.INT = 1;
+    PieCtrlRegs.PIEACK.all  = PIEACK_GROUP3;
+} /* End f_PwmSyncReqIsr */
+
+#endif /* COMEX_USE_PWM_SYNC */
@@ -0,0 +1,625 @@
+/*
+ * Sci_Port.c
+ *
+ *  SCI driver. Every call works on a port (SCI_PORT_TYPE): the
+ *  register block plus that port's receive queue, framer state and
+ *  statistics, so SCIA-SCID can each run an IMU at the same time.
+ *
+ *  Each port has its own RX FIFO interrupt, but they are all thin
+ *  wrappers around f_SciRxService, which does the framing on the
+ *  port they hand it. The only cost of a further link is its own
+ *  interrupts.
+ *
+ *  Completed frames are assembled straight into packet pool blocks
+ *  and only the block pointers are queued (single producer/consumer
+ *  per port), so nothing is copied on the way to the foreground.
+ *
+ *  A port can also transmit from a byte ring (f_SciTx_Init), which
+ *  its TX FIFO interrupt drains while the foreground fills it.
+ */
+
+#include "COMEX_Proj.h"
+
+
+/* Hot path, runs from LS RAM in every build (see COMEX_Sections.cmd) */
+#pragma CODE_SECTION(f_SciRxService, "ComexHotCode");
+#pragma CODE_SECTION(f_SciaRxIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_ScibRxIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_ScicRxIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_ScidRxIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_SciTxService, "ComexHotCode");
+#pragma CODE_SECTION(f_SciaTxIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_ScibTxIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_ScicTxIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_ScidTxIsr, "ComexHotCode");
+#pragma CODE_SECTION(f_RxFrameGet, "ComexHotCode");
+#pragma CODE_SECTION(f_RxFrameTake, "ComexHotCode");
+
+#pragma DATA_SECTION(g_SciPorts, "ComexRxRing");
+SCI_PORT_TYPE g_SciPorts[SCI_NPORTS];
+
+
+/* What differs between the ports in hardware.
+** Pins are this board's wiring, change them here */
+typedef struct
+{
+    volatile struct SCI_REGS *Regs;
+    volatile PINT *RxVect;     /* PIE vector of the RX interrupt */
+    PINT   RxIsr;
+    volatile PINT *TxVect;     /* PIE vector of the TX interrupt */
+    PINT   TxIsr;
+    Uint16 PieGroup;           /* 8 or 9 */
+    Uint16 PieBit;             /* RX interrupt's bit in PIEIERx */
+    Uint16 TxPieBit;           /* TX interrupt's bit in PIEIERx */
+    Uint16 RxPin;
+    Uint16 TxPin;
+    Uint16 Mux;
+} SCI_PORT_HW_TYPE;
+
+static const SCI_PORT_HW_TYPE s_SciHw[SCI_NPORTS] =
+{
+    /* SCIA: GPIO28/29, PIE 9.1 (RX) 9.2 (TX) */
+    { &SciaRegs, &PieVectTable.SCIA_RX_INT, &f_SciaRxIsr, &PieVectTable.SCIA_TX_INT, &f_SciaTxIsr, 9, 0x0001, 0x0002,  28, 29, 1 },
+    /* SCIB: GPIO19/18, PIE 9.3 9.4 */
+    { &ScibRegs, &PieVectTable.SCIB_RX_INT, &f_ScibRxIsr, &PieVectTable.SCIB_TX_INT, &f_ScibTxIsr, 9, 0x0004, 0x0008,  19, 18, 2 },
+    /* SCIC: GPIO139/56, PIE 8.5 8.6 */
+    { &ScicRegs, &PieVectTable.SCIC_RX_INT, &f_ScicRxIsr, &PieVectTable.SCIC_TX_INT, &f_ScicTxIsr, 8, 0x0010, 0x0020, 139, 56, 6 },
+    /* SCID: GPIO46/47, PIE 8.7 8.8 */
+    { &ScidRegs, &PieVectTable.SCID_RX_INT, &f_ScidRxIsr, &PieVectTable.SCID_TX_INT, &f_ScidTxIsr, 8, 0x0040, 0x0080,  46, 47, 6 },
+};
+
+
+
+/*
+** f_SciPort_Init
+** Bind every port handle to its registers. No hardware is
+** touched, call once before using any port */
+void f_SciPort_Init( void )
+{
+    Uint16 Id;
+
+    memset( g_SciPorts, 0, sizeof(g_SciPorts) );
+    for( Id=0; Id<SCI_NPORTS; Id++ )
+    {
+        g_SciPorts[Id].Regs  = s_SciHw[Id].Regs;
+        g_SciPorts[Id].Id    = Id;
+        g_SciPorts[Id].pWork = &g_SciPorts[Id].Scratch;
+    }
+} /* End f_SciPort_Init */
+
+
+
+/*
+** f_SciPort_Pins
+** Route the port's RX/TX pins to the SCI, driven by Cpu
+** (GPIO_MUX_CPU1 or GPIO_MUX_CPU2). CPU1 only, the GPIO mux
+** is not accessible from CPU2 */
+void f_SciPort_Pins( SCI_PORT_TYPE *Port, Uint16 Cpu )
+{
+    const SCI_PORT_HW_TYPE *Hw = &s_SciHw[Port->Id];
+
+    GPIO_SetupPinMux( Hw->RxPin, Cpu, Hw->Mux );
+    GPIO_SetupPinOptions( Hw->RxPin, GPIO_INPUT, GPIO_PUSHPULL );
+    GPIO_SetupPinMux( Hw->TxPin, Cpu, Hw->Mux );
+    GPIO_SetupPinOptions( Hw->TxPin, GPIO_OUTPUT, GPIO_ASYNC );
+} /* End f_SciPort_Pins */
+
+
+
+/*
+** f_SciPort_Bridge
+** Copy every byte From receives to the TX FIFO of To (0 stops it).
+** To must be set up (f_fifo_init, f_sci_init) at a baud which can
+** keep up with From */
+void f_SciPort_Bridge( SCI_PORT_TYPE *From, SCI_PORT_TYPE *To )
+{
+    From->Forward = To;
+} /* End f_SciPort_Bridge */
+
+
+
+/*
+** f_sci_init
+** 8 data bits, 1 stop bit, no parity, no loopback, at Baud.
+** Baud register from LSPCLK: BAUD = LSPCLK / ((BRR+1)*8) */
+void f_sci_init( SCI_PORT_TYPE *Port, Uint32 Baud )
+{
+    volatile struct SCI_REGS *Regs = Port->Regs;
+    Uint16 Brr = (Uint16)(COMEX_LSPCLK_HZ / (8UL*Baud)) - 1;
+
+    Regs->SCICCR.all  = 0x0007;  // 1 stop bit,  No loopback, No parity, 8 char bits, async mode, idle-line protocol
+    Regs->SCICTL1.all = 0x0003;  // enable TX, RX, internal SCICLK, Disable RX ERR, SLEEP, TXWAKE
+
+    Regs->SCICTL2.all = 0x0003;       // Disable txrdy and rxrdy interupt
+    Regs->SCICTL2.bit.TXINTENA = 1;   // redundant of above
+    Regs->SCICTL2.bit.RXBKINTENA = 1; // redundant of above
+
+    /* 9600 baud at 25 MHz LSPCLK is 0x0144 */
+    Regs->SCIHBAUD.all = Brr >> 8;
+    Regs->SCILBAUD.all = Brr & 0xFF;
+
+    Regs->SCICTL1.all  = 0x0023;  // Relinquish SCI from SW Reset
+
+    Port->ByteTicks = SCI_BYTE_TICKS( Baud );
+} /* End of f_sci_init */
+
+
+
+/*
+** f_fifo_init
+** Initialize the SCI FIFO */
+void f_fifo_init( SCI_PORT_TYPE *Port )
+{
+    volatile struct SCI_REGS *Regs = Port->Regs;
+
+    Regs->SCIFFTX.all = 0xE043; // resume transmit/recieve, fifo enhancements enabled, re-enable transmit fifo, clear TXFFINT
+    Regs->SCIFFRX.all = 0x2044; // re-enable fifo revieve, set interupt lvl (4), set rx interupt at gteq to interupt lvl
+    Regs->SCIFFRX.bit.RXFFINTCLR = 1; // clear interupt
+    Regs->SCIFFTX.bit.TXFFINTCLR = 1; // clear interupt
+
+    /* Auto-baud register will be set in f_Handshake */
+    Regs->SCIFFCT.all = 0x4000;   // clear ABD flag, disable auto baud, no fifo delay
+} /* End of f_fifo_init */
+
+
+
+/*
+** f_rx_isr_init
+** Move the port's reception onto its RX FIFO interrupt.
+** Must come after f_Handshake, which polls the FIFO itself.
+** Interrupts a level of 1 byte, so each byte is stamped as
+** soon as it lands (see f_SciRxService) */
+void f_rx_isr_init( SCI_PORT_TYPE *Port )
+{
+    const SCI_PORT_HW_TYPE *Hw = &s_SciHw[Port->Id];
+
+    f_RxReset( Port );
+
+    EALLOW;
+    *Hw->RxVect = Hw->RxIsr;
+    EDIS;
+
+    Port->Regs->SCIFFRX.bit.RXFFIL      = 1;
+    Port->Regs->SCIFFRX.bit.RXFFINTCLR  = 1;
+    Port->Regs->SCIFFRX.bit.RXFFIENA    = 1;
+
+    if( Hw->PieGroup == 9 )
+    {
+        PieCtrlRegs.PIEIER9.all |= Hw->PieBit;
+        IER |= M_INT9;
+    }
+    else
+    {
+        PieCtrlRegs.PIEIER8.all |= Hw->PieBit;
+        IER |= M_INT8;
+    }
+} /* End of f_rx_isr_init */
+
+
+
+/*
+** f_WaitTxEmpty
+** Wait for the port's transmitter to empty, or Deadline */
+Uint16 f_WaitTxEmpty( SCI_PORT_TYPE *Port, DEADLINE_TYPE Deadline )
+{
+    while( Port->Regs->SCICTL2.bit.TXEMPTY == 0 )
+    {
+        if( f_Deadline_Expired( Deadline ) ) { return( IO_TIMEOUT ); }
+    }
+    return( IO_OK );
+} /* End f_WaitTxEmpty */
+
+
+
+#if COMEX_USE_HANDSHAKE
+/*
+** f_WaitRxFifo
+** Wait for at least one byte in the port's RX FIFO, or Deadline.
+** Only for polled receive (the RX ISR is not enabled yet) */
+Uint16 f_WaitRxFifo( SCI_PORT_TYPE *Port, DEADLINE_TYPE Deadline )
+{
+    while( Port->Regs->SCIFFRX.bit.RXFFST == 0 )
+    {
+        if( f_Deadline_Expired( Deadline ) ) { return( IO_TIMEOUT ); }
+    }
+    return( IO_OK );
+} /* End f_WaitRxFifo */
+#endif
+
+
+
+/*
+** f_xmit_char
+** Transmit a single character */
+void f_xmit_char( SCI_PORT_TYPE *Port, char xmitChar )
+{
+    Port->Regs->SCITXBUF.all = xmitChar;
+} /* End f_xmit_char */
+
+
+
+#if COMEX_USE_HANDSHAKE
+/*
+** f_rcv_char
+** Receive a single character */
+void f_rcv_char( SCI_PORT_TYPE *Port, char *InputBuffer )
+{
+    InputBuffer[0] = Port->Regs->SCIRXBUF.bit.SAR;
+} /* End f_rcv_char */
+#endif
+
+
+
+
+/***************************************************************************
+*************************** Interrupt driven receive ***********************
+****************************************************************************/
+
+/*
+** f_SciPort_Stop
+** Stop the port's RX interrupt and give back every pool block it
+** holds: queued frames and a frame part way in. Ready for a
+** rebuild (f_fifo_init, f_sci_init, f_rx_isr_init) */
+void f_SciPort_Stop( SCI_PORT_TYPE *Port )
+{
+  PKT_BLOCK_TYPE *Block;
+
+  Port->Regs->SCIFFRX.bit.RXFFIENA = 0;
+
+  while( (Block = f_RxFrameTake( Port )) != 0 ) { f_PktPool_Free( Block ); }
+
+  /* pBlock still points at the last completed frame between
+  ** frames, it is only ours while a frame is being received */
+  if( (Port->Phase != RX_PHASE_LEN_HI) && (Port->pBlock != 0) )
+  {
+    f_PktPool_Free( Port->pBlock );
+  }
+  Port->pBlock = 0;
+  Port->Phase  = RX_PHASE_LEN_HI;
+} /* End f_SciPort_Stop */
+
+
+
+/*
+** f_RxReset
+** Drop any partly received frame and every queued frame.
+** Call with the port's RX interrupt disabled, or before it is
+** enabled. Blocks still queued are not given back, so only call
+** it on a freshly initialised pool (f_Initialize) or after
+** f_SciPort_Stop */
+void f_RxReset( SCI_PORT_TYPE *Port )
+{
+  Port->Head   = 0;
+  Port->Tail   = 0;
+  Port->Phase  = RX_PHASE_LEN_HI;
+  Port->Count  = 0;
+  Port->pWork  = &Port->Scratch;
+  Port->pBlock = 0;
+} /* End f_RxReset */
+
+
+
+/*
+** f_RxFrameTake
+** Take the oldest completed frame on Port without copying it.
+** The caller owns the block and must f_PktPool_Free it.
+** Returns 0 if none is waiting */
+PKT_BLOCK_TYPE *f_RxFrameTake( SCI_PORT_TYPE *Port )
+{
+  Uint16 Tail = Port->Tail;
+  PKT_BLOCK_TYPE *Block;
+
+  if( Port->Head == Tail ) { return( 0 ); }
+
+  Block = Port->Queue[Tail & (RX_FRAME_DEPTH-1)];
+  Port->Tail = Tail + 1;
+
+  return( Block );
+} /* End f_RxFrameTake */
+
+
+
+/*
+** f_RxFrameGet
+** Copy out the oldest completed frame on Port.
+** Returns FALSE if none is waiting */
+bool f_RxFrameGet( SCI_PORT_TYPE *Port, RX_FRAME_TYPE *Frame )
+{
+  PKT_BLOCK_TYPE *Block = f_RxFrameTake( Port );
+
+  if( Block == 0 ) { return( FALSE ); }
+
+  *Frame = Block->Frame;
+  f_PktPool_Free( Block );
+
+  return( TRUE );
+} /* End f_RxFrameGet */
+
+
+
+/*
+** f_SciRxService
+** Body of every RX FIFO interrupt.
+** Frames the packet byte by byte: 2 length bytes, then the body.
+** Each byte gets an IPC counter stamp, back dated by one byte time
+** for every byte still behind it in the FIFO, so the first and
+** last byte stamps are good to about a byte time regardless of
+** the FIFO level or interrupt latency.
+**
+** With a bridge (Port->Forward) each byte is written to the bridge
+** port's TX FIFO before it is framed, cut-through: it goes out as
+** soon as it lands instead of once the packet is complete, about a
+** byte time plus interrupt latency behind the IMU. The framer never
+** sees the bridge. If the bridge TX FIFO is full the byte is
+** dropped from the bridge only, and counted.
+**
+** With COMEX_USE_FEC every byte arrives as two Hamming(8,4)
+** codewords (Fec.c). They are decoded after the bridge (which
+** passes the coded stream on) and only the rebuilt byte is framed.
+** A line idle for FEC_RESYNC_BYTES puts the pairing back in step */
+void f_SciRxService( SCI_PORT_TYPE *Port )
+{
+  volatile struct SCI_REGS *Regs = Port->Regs;
+  volatile struct SCI_REGS *FwdRegs = 0;
+  Uint16 k, nFifo;
+#if COMEX_USE_FEC
+  Uint16 Code;
+#endif
+  unsigned char Byte;
+  Uint64 Now, Stamp;
+
+  nFifo = Regs->SCIFFRX.bit.RXFFST;
+  Now   = ReadIpcTimer();
+
+  if( Port->Forward != 0 ) { FwdRegs = Port->Forward->Regs; }
+
+  for( k=0; k<nFifo; k++ )
+  {
+    Byte  = Regs->SCIRXBUF.bit.SAR;
+    Stamp = Now - (Uint64)(nFifo-1-k) * Port->ByteTicks;
+
+    if( FwdRegs != 0 )
+    {
+      if( FwdRegs->SCIFFTX.bit.TXFFST < SCI_FIFO_DEPTH )
+      {
+        FwdRegs->SCITXBUF.all = Byte;
+        Port->Stats.Forwarded++;
+      }
+      else
+      {
+        Port->Stats.ForwardDrops++;
+      }
+    }
+
+#if COMEX_USE_FEC
+    if( Stamp - Port->FecLast > (Uint64)FEC_RESYNC_BYTES*Port->ByteTicks ) { Port->FecHalf = 0; }
+    Port->FecLast = Stamp;
+
+    Code = g_FecLut[Byte];
+    if( Code & FEC_CORRECTED ) { Port->Stats.FecCorrected++; }
+    if( Code & FEC_BAD )       { Port->Stats.FecBad++; }
+    if( Port->FecHalf == 0 )
+    {
+      Port->FecHi   = Code & 0xF;
+      Port->FecHalf = 1;
+      continue;
+    }
+    Port->FecHalf = 0;
+    Byte = (Port->FecHi << 4) | (Code & 0xF);
+#endif
+
+    switch( Port->Phase )
+    {
+      case RX_PHASE_LEN_HI:
+        /* Start of frame. Take a pool block if there is a queue slot
+        ** to put it in once it is complete (the slot can only stay free,
+        ** the foreground only ever empties the queue) */
+        Port->pBlock = 0;
+        if( (Uint16)(Port->Head - Port->Tail) < RX_FRAME_DEPTH )
+        {
+          Port->pBlock = f_PktPool_Alloc();
+        }
+        Port->pWork = (Port->pBlock != 0) ? &Port->pBlock->Frame : &Port->Scratch;
+        Port->pWork->FirstStamp = Stamp;
+        Port->pWork->nBytes     = Byte << 8;
+        Port->Phase = RX_PHASE_LEN_LO;
+        break;
+
+      case RX_PHASE_LEN_LO:
+        Port->pWork->nBytes |= Byte;
+        if( (Port->pWork->nBytes < RX_PACKET_MIN) || (Port->pWork->nBytes > RX_PACKET_MAX) )
+        {
+          Port->Stats.BadLength++;
+          if( Port->pBlock != 0 ) { f_PktPool_Free( Port->pBlock ); }
+          Port->Phase = RX_PHASE_LEN_HI;
+        }
+        else
+        {
+          Port->Count = 0;
+          Port->Phase = RX_PHASE_BODY;
+        }
+        break;
+
+      default:
+        Port->pWork->Bytes[Port->Count++] = Byte;
+        if( Port->Count == Port->pWork->nBytes )
+        {
+          Port->pWork->LastStamp = Stamp;
+          if( Port->pBlock != 0 )
+          {
+            Port->Queue[Port->Head & (RX_FRAME_DEPTH-1)] = Port->pBlock;
+            Port->Head++;
+            Port->Stats.Frames++;
+          }
+          else
+          {
+            Port->Stats.Overruns++;
+          }
+          Port->Phase = RX_PHASE_LEN_HI;
+        }
+        break;
+    }
+  }
+
+  if( Regs->SCIFFRX.bit.RXFFOVF == 1 )
+  {
+    Port->Stats.FifoOverflows++;
+    Regs->SCIFFRX.bit.RXFFOVRCLR = 1;
+  }
+
+  Regs->SCIFFRX.bit.RXFFINTCLR = 1;
+} /* End f_SciRxService */
+
+
+
+/*
+** f_SciaRxIsr .. f_ScidRxIsr
+** RX FIFO interrupt of each port */
+__interrupt void f_SciaRxIsr( void )
+{
+  f_SciRxService( &g_SciPorts[SCI_PORT_A] );
+  PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+} /* End f_SciaRxIsr */
+
+__interrupt void f_ScibRxIsr( void )
+{
+  f_SciRxService( &g_SciPorts[SCI_PORT_B] );
+  PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+} /* End f_ScibRxIsr */
+
+__interrupt void f_ScicRxIsr( void )
+{
+  f_SciRxService( &g_SciPorts[SCI_PORT_C] );
+  PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;
+} /* End f_ScicRxIsr */
+
+__interrupt void f_ScidRxIsr( void )
+{
+  f_SciRxService( &g_SciPorts[SCI_PORT_D] );
+  PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;
+} /* End f_ScidRxIsr */
+
+
+
+
+/***************************************************************************
+*************************** Interrupt driven transmit **********************
+****************************************************************************/
+
+/*
+** f_SciTx_Init
+** Transmit Port's output from Ring, Size bytes (a power of 2),
+** from its TX FIFO interrupt. The interrupt is only enabled while
+** the ring holds something (f_SciTx_Write) */
+void f_SciTx_Init( SCI_PORT_TYPE *Port, SCI_TX_RING_TYPE *Ring, unsigned char *Buf, Uint16 Size )
+{
+    const SCI_PORT_HW_TYPE *Hw = &s_SciHw[Port->Id];
+
+    Ring->Buf  = Buf;
+    Ring->Size = Size;
+    Ring->Head = 0;
+    Ring->Tail = 0;
+    Port->Tx   = Ring;
+
+    EALLOW;
+    *Hw->TxVect = Hw->TxIsr;
+    EDIS;
+
+    /* Interrupt while the FIFO is down to SCI_TX_REFILL, so it is
+    ** topped up before the line goes idle */
+    Port->Regs->SCIFFTX.bit.TXFFIENA   = 0;
+    Port->Regs->SCIFFTX.bit.TXFFIL     = SCI_TX_REFILL;
+    Port->Regs->SCIFFTX.bit.TXFFINTCLR = 1;
+
+    if( Hw->PieGroup == 9 )
+    {
+        PieCtrlRegs.PIEIER9.all |= Hw->TxPieBit;
+        IER |= M_INT9;
+    }
+    else
+    {
+        PieCtrlRegs.PIEIER8.all |= Hw->TxPieBit;
+        IER |= M_INT8;
+    }
+} /* End f_SciTx_Init */
+
+
+
+/*
+** f_SciTx_Write
+** Queue n bytes for transmission, all or none.
+** Returns FALSE, queueing nothing, if the ring hasn't room.
+** Foreground only (single producer) */
+bool f_SciTx_Write( SCI_PORT_TYPE *Port, unsigned char *Bytes, Uint16 n )
+{
+    SCI_TX_RING_TYPE *Ring = Port->Tx;
+    Uint16 k, Head = Ring->Head;
+
+    if( (Uint16)(Head - Ring->Tail) + n > Ring->Size ) { return( FALSE ); }
+
+    for( k=0; k<n; k++ )
+    {
+        Ring->Buf[(Head + k) & (Ring->Size-1)] = Bytes[k];
+    }
+    Ring->Head = Head + n;
+
+    /* The ISR turns this off once the ring is empty. It can't do so
+    ** between the Head update and here without sending the new bytes */
+    Port->Regs->SCIFFTX.bit.TXFFIENA = 1;
+
+    return( TRUE );
+} /* End f_SciTx_Write */
+
+
+
+/*
+** f_SciTxService
+** Body of every TX FIFO interrupt. Fill the TX FIFO from the
+** ring, and stop interrupting once the ring is empty */
+void f_SciTxService( SCI_PORT_TYPE *Port )
+{
+  volatile struct SCI_REGS *Regs = Port->Regs;
+  SCI_TX_RING_TYPE *Ring = Port->Tx;
+  Uint16 Tail = Ring->Tail;
+  Uint16 Head = Ring->Head;
+
+  while( (Tail != Head) && (Regs->SCIFFTX.bit.TXFFST < SCI_FIFO_DEPTH) )
+  {
+    Regs->SCITXBUF.all = Ring->Buf[Tail & (Ring->Size-1)];
+    Tail++;
+  }
+  Ring->Tail = Tail;
+
+  if( Tail == Head ) { Regs->SCIFFTX.bit.TXFFIENA = 0; }
+
+  Regs->SCIFFTX.bit.TXFFINTCLR = 1;
+} /* End f_SciTxService */
+
+
+
+/*
+** f_SciaTxIsr .. f_ScidTxIsr
+** TX FIFO interrupt of each port */
+__interrupt void f_SciaTxIsr( void )
+{
+  f_SciTxService( &g_SciPorts[SCI_PORT_A] );
+  PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+} /* End f_SciaTxIsr */
+
+__interrupt void f_ScibTxIsr( void )
+{
+  f_SciTxService( &g_SciPorts[SCI_PORT_B] );
+  PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+} /* End f_ScibTxIsr */
+
+__interrupt void f_ScicTxIsr( void )
+{
+  f_SciTxService( &g_SciPorts[SCI_PORT_C] );
+  PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;
+} /* End f_ScicTxIsr */
+
+__interrupt void f_ScidTxIsr( void )
+{
+  f_SciTxService( &g_SciPorts[SCI_PORT_D] );
+  PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;
+} /* End f_ScidTxIsr */
@@ -0,0 +1,160 @@
+/*
+ * Supervisor.c
+ *
+ *  Watchdog supervision and link recovery (COMEX_USE_SUPERVISOR).
+ *
+ *  f_Super_Task runs last in every executive cycle. It rebuilds any
+ *  IMU link which has gone LINK_STALL_US without a good packet
+ *  (f_Link_Rebuild: SCI from scratch, handshake, reception), so a
+ *  glitch costs one stall time and a rebuild instead of a hang.
+ *  The watchdog is serviced only from healthy cycles: every task of
+ *  the cycle done in time, and the primary link alive or still
+ *  within LINK_MAX_REBUILDS rebuilds. Anything else that stops the
+ *  executive, or a primary IMU which never comes back, ends in a
+ *  watchdog reset.
+ *
+ *  g_Retain lives in a NOINIT section, so the reset cause, reset
+ *  counts and link outage times survive the watchdog (or any other
+ *  non power on) reset for a debugger or telemetry to read.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#if COMEX_USE_SUPERVISOR
+
+#pragma DATA_SECTION(g_Retain, "ComexRetain");
+RETAIN_TYPE g_Retain;
+
+#pragma DATA_SECTION(g_SuperStats, "ComexTrace");
+SUPER_STATS_TYPE g_SuperStats;
+
+static Uint32 s_FrameOverruns;   /* g_ExecStats.FrameOverruns at the last cycle */
+
+
+
+/*
+** f_Super_Init
+** Note why we were reset and bring the retained record up to
+** date. Call first thing after f_Initialize */
+void f_Super_Init( void )
+{
+    Uint32 Cause = CpuSysRegs.RESC.all;
+
+    if( (g_Retain.Magic != RETAIN_MAGIC) || CpuSysRegs.RESC.bit.POR )
+    {
+        memset( &g_Retain, 0, sizeof(RETAIN_TYPE) );
+        g_Retain.Magic = RETAIN_MAGIC;
+    }
+
+    g_Retain.Boots++;
+    g_Retain.LastCause = Cause;
+    if( CpuSysRegs.RESC.bit.WDRSn ) { g_Retain.WatchdogResets++; }
+
+    /* Write 1 to clear, so the next boot only sees its own cause */
+    EALLOW;
+    CpuSysRegs.RESC.all = Cause;
+    EDIS;
+
+    memset( &g_SuperStats, 0, sizeof(SUPER_STATS_TYPE) );
+} /* End f_Super_Init */
+
+
+
+/*
+** f_Super_Start
+** Start the stall timers and the watchdog (InitSysCtrl leaves it
+** disabled). Call just before f_Exec_Start, the executive has to
+** service it from here on */
+void f_Super_Start( void )
+{
+    Uint16 Id;
+    Uint64 Now = ReadIpcTimer();
+
+    for( Id=0; Id<LINK_NPORTS; Id++ )
+    {
+        if( COMEX_IMU_PORTS & (1 << Id) ) { g_Links[Id].RebuildStamp = Now; }
+    }
+    s_FrameOverruns = g_ExecStats.FrameOverruns;
+
+    EALLOW;
+    WdRegs.SCSR.all = 0x0000;                 // WDENINT = 0, the watchdog resets the device
+    WdRegs.WDCR.all = 0x0028 | WD_PRESCALE;   // WDCHK = 101, WDDIS = 0
+    EDIS;
+    ServiceDog();
+} /* End f_Super_Start */
+
+
+
+/*
+** f_Super_Task
+** Executive task, registered last: rebuild stalled links, then
+** service the watchdog if the cycle was healthy */
+void f_Super_Task( void )
+{
+    Uint16 Id;
+    bool Healthy = TRUE;
+    LINK_TYPE *Link;
+    Uint64 Since;
+    Uint64 Now   = ReadIpcTimer();
+    Uint64 Stall = (Uint64)LINK_STALL_US*IPC_TICKS_PER_US;
+
+    for( Id=0; Id<LINK_NPORTS; Id++ )
+    {
+        if( (COMEX_IMU_PORTS & (1 << Id)) == 0 ) { continue; }
+        Link = &g_Links[Id];
+
+        Since = (Link->LastGood > Link->RebuildStamp) ? Link->LastGood : Link->RebuildStamp;
+        if( Now - Since < Stall ) { continue; }
+
+        if( Link->Rebuilds == 0 ) { Link->StallStart = Link->LastGood; }
+        f_Link_Rebuild( Link );
+        Link->Rebuilds++;
+        Link->RebuildStamp = ReadIpcTimer();
+        g_Retain.Rebuilds++;
+    }
+
+    /* Everything ran in time since the last cycle */
+    if( g_ExecStats.FrameOverruns != s_FrameOverruns )
+    {
+        s_FrameOverruns = g_ExecStats.FrameOverruns;
+        Healthy = FALSE;
+    }
+
+    /* Failover has found no other link, and rebuilding isn't working */
+    if( g_Links[g_LinkPrimary].Rebuilds >= LINK_MAX_REBUILDS ) { Healthy = FALSE; }
+
+    if( Healthy )
+    {
+        ServiceDog();
+        g_SuperStats.Serviced++;
+    }
+    else
+    {
+        g_SuperStats.Unhealthy++;
+    }
+} /* End f_Super_Task */
+
+
+
+/*
+** f_Super_Recovered
+** First good packet on a link which was rebuilt: record how long
+** it was down */
+void f_Super_Recovered( LINK_TYPE *Link )
+{
+    Uint32 Outage_us;
+
+    /* A link which never delivered has no outage to speak of */
+    if( Link->StallStart != 0 )
+    {
+        Outage_us = (Uint32)((Link->LastGood - Link->StallStart) / IPC_TICKS_PER_US);
+        g_Retain.OutageLast_us = Outage_us;
+        if( Outage_us > g_Retain.OutageMax_us ) { g_Retain.OutageMax_us = Outage_us; }
+    }
+
+    g_Retain.Recoveries++;
+    Link->Rebuilds = 0;
+} /* End f_Super_Recovered */
+
+#endif /* COMEX_USE_SUPERVISOR */
@@ -0,0 +1,195 @@
+/*
+ * Telemetry.c
+ *
+ *  Telemetry stream on a SCI port of its own (TELEM_PORT), so a
+ *  unit can be watched without a debugger attached.
+ *
+ *  f_Telem_Task runs off the executive every TELEM_DECIMATION
+ *  ticks and packs one record of the TELEM_CHANNELS into the frame
+ *  being built. Every TELEM_BATCH records the frame is closed
+ *  (length, checksum) and queued on the port's TX ring in one go;
+ *  the TX FIFO interrupt sends it from there (f_SciTxService), so
+ *  the task never waits on the line. A frame the ring has no room
+ *  for is dropped whole and counted, the Seq gap shows it on the
+ *  host as well. Frame layout is in COMEX_Proj.h, the host decoder
+ *  is tools/telem_decode.py.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#if COMEX_USE_TELEMETRY
+
+#if TELEM_FRAME_MAX > TELEM_RING_BYTES
+#error "TELEM_RING_BYTES can't hold a frame of TELEM_BATCH records"
+#endif
+
+static unsigned char    s_TelemRingBuf[TELEM_RING_BYTES];
+static SCI_TX_RING_TYPE s_TelemRing;
+static unsigned char    s_TelemFrame[TELEM_FRAME_MAX];
+
+static Uint16 s_TelemLen;      /* Bytes in s_TelemFrame so far */
+static Uint16 s_TelemRecords;  /* Records in s_TelemFrame so far */
+
+#pragma DATA_SECTION(g_TelemStats, "ComexTrace");
+TELEM_STATS_TYPE g_TelemStats;
+
+
+
+/*
+** f_TelemPut8 .. f_TelemPutF32
+** Append a value to the frame, big endian, one byte per char */
+static void f_TelemPut8( Uint16 Value )
+{
+    s_TelemFrame[s_TelemLen++] = Value & 0xFF;
+} /* End f_TelemPut8 */
+
+static void f_TelemPut16( Uint16 Value )
+{
+    f_TelemPut8( Value >> 8 );
+    f_TelemPut8( Value );
+} /* End f_TelemPut16 */
+
+static void f_TelemPut32( Uint32 Value )
+{
+    f_TelemPut16( (Uint16)(Value >> 16) );
+    f_TelemPut16( (Uint16)Value );
+} /* End f_TelemPut32 */
+
+static void f_TelemPutF32( float Value )
+{
+    union { float f; Uint32 u; } Bits;
+
+    Bits.f = Value;
+    f_TelemPut32( Bits.u );
+} /* End f_TelemPutF32 */
+
+
+
+/*
+** f_TelemStart
+** Start a new frame. Length and checksum are filled in by
+** f_TelemClose */
+static void f_TelemStart( void )
+{
+    s_TelemLen     = 0;
+    s_TelemRecords = 0;
+
+    f_TelemPut8( TELEM_SYNC0 );
+    f_TelemPut8( TELEM_SYNC1 );
+    f_TelemPut16( 0 );                    /* Length */
+    f_TelemPut8( g_TelemStats.Seq );
+    f_TelemPut8( TELEM_CHANNELS );
+    f_TelemPut8( 0 );                     /* nRecords */
+} /* End f_TelemStart */
+
+
+
+/*
+** f_TelemClose
+** Fill in length, record count and checksum and queue the frame */
+static void f_TelemClose( void )
+{
+    Uint16 Length = s_TelemLen - 4;
+
+    s_TelemFrame[2] = Length >> 8;
+    s_TelemFrame[3] = Length & 0xFF;
+    s_TelemFrame[6] = s_TelemRecords;
+    f_TelemPut8( f_CheckSum( &s_TelemFrame[4], Length ) );
+
+    if( f_SciTx_Write( &g_SciPorts[TELEM_PORT], s_TelemFrame, s_TelemLen ) )
+    {
+        g_TelemStats.Frames++;
+    }
+    else
+    {
+        g_TelemStats.Dropped++;
+    }
+    g_TelemStats.Seq++;
+} /* End f_TelemClose */
+
+
+
+/*
+** f_TelemRecord
+** Append one record of the TELEM_CHANNELS */
+static void f_TelemRecord( void )
+{
+    LINK_TYPE *Link = &g_Links[g_LinkPrimary];
+#if TELEM_CHANNELS & TELEM_CH_PROFILE
+    Uint16 i;
+#endif
+
+#if TELEM_CHANNELS & TELEM_CH_STAMPS
+    f_TelemPut32( (Uint32)ReadIpcTimer() );
+    f_TelemPut32( (Uint32)Link->Sample.SampleStamp );
+#endif
+
+#if TELEM_CHANNELS & TELEM_CH_RPY
+    f_TelemPutF32( Link->Sample.Roll );
+    f_TelemPutF32( Link->Sample.Pitch );
+    f_TelemPutF32( Link->Sample.Yaw );
+#endif
+
+#if TELEM_CHANNELS & TELEM_CH_HEALTH
+    f_TelemPut8( g_LinkPrimary );
+    f_TelemPut16( (Uint16)Link->Stats.Good );
+    f_TelemPut16( Link->Stats.Timeouts );
+    f_TelemPut16( Link->Stats.BadChecksum );
+    f_TelemPut16( Link->Port->Stats.Overruns );
+    f_TelemPut16( Link->Port->Stats.FifoOverflows );
+    f_TelemPut16( g_PktPoolStats.Empty );
+    f_TelemPut16( (Uint16)g_ExecStats.MissedTicks );
+    f_TelemPut16( g_TelemStats.Dropped );
+#endif
+
+#if TELEM_CHANNELS & TELEM_CH_PROFILE
+    f_TelemPut8( g_ExecStats.nTasks );
+    for( i=0; i<g_ExecStats.nTasks; i++ )
+    {
+        f_TelemPut32( g_ExecTasks[i].ExecLast );
+        f_TelemPut32( g_ExecTasks[i].ExecMax );
+        f_TelemPut16( (Uint16)g_ExecTasks[i].Overruns );
+    }
+#endif
+
+    s_TelemRecords++;
+    g_TelemStats.Records++;
+} /* End f_TelemRecord */
+
+
+
+/*
+** f_Telem_Init
+** Open TELEM_PORT and start the first frame. Register
+** f_Telem_Task with the executive every TELEM_DECIMATION ticks */
+void f_Telem_Init( void )
+{
+    SCI_PORT_TYPE *Port = &g_SciPorts[TELEM_PORT];
+
+    memset( &g_TelemStats, 0, sizeof(TELEM_STATS_TYPE) );
+
+    f_fifo_init( Port );
+    f_sci_init( Port, TELEM_BAUD );
+    f_SciTx_Init( Port, &s_TelemRing, s_TelemRingBuf, TELEM_RING_BYTES );
+
+    f_TelemStart();
+} /* End f_Telem_Init */
+
+
+
+/*
+** f_Telem_Task
+** Executive task: one record, and the frame out once it is full */
+void f_Telem_Task( void )
+{
+    f_TelemRecord();
+
+    if( s_TelemRecords >= TELEM_BATCH )
+    {
+        f_TelemClose();
+        f_TelemStart();
+    }
+} /* End f_Telem_Task */
+
+#endif /* COMEX_USE_TELEMETRY */
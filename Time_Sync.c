@@ -0,0 +1,310 @@
+/*
+ * Time_Sync.c
+ *
+ *  IMU clock alignment. With packet type 5 the IMU sends its own
+ *  sample time; the arrival stamp of the packet (RX ISR) differs
+ *  from it by a transport delay, an offset between the clocks and
+ *  the drift of the IMU's oscillator against ours. Per link, a
+ *  least squares line through the last TIME_SYNC_DEPTH (IMU time,
+ *  arrival) pairs maps IMU time onto the IPC counter. Each window
+ *  pair is the mean of TIME_SYNC_SPACING_US worth of samples, so
+ *  the window spans seconds, long enough to see drift of a few
+ *  ppm, and the jitter is averaged down before the fit. The fit
+ *  averages out the remaining jitter and follows the drift, so
+ *  Data->SampleStamp is the sample's own time on our clock rather
+ *  than whenever its packet happened to land.
+ *
+ *  The fixed part of the transport delay looks the same as clock
+ *  offset and can't be estimated from one way stamps; it is taken
+ *  off as TIME_SYNC_DELAY_US.
+ *
+ *  Times go into the fit relative to the newest pair (us, float),
+ *  which keeps them small enough for single float. Pairs far off
+ *  the current fit (a late packet) are skipped, but enough of them
+ *  in a row, or the IMU clock going backwards (IMU reset), restart
+ *  the window. A stamp the same as the last (the IMU sent the same
+ *  sample again) is skipped.
+ *
+ *  f_TimeSync_Check (COMEX_INSTRUMENT INSTR_BENCH) runs the
+ *  estimator on a synthetic link with injected skew and jitter
+ *  and records the estimation error on target.
+ *  tools/time_sync_sim.py builds this file on the host and runs the
+ *  check for other skews, jitter and window sizes.
+ */
+
+#include "COMEX_Proj.h"
+
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+TIME_SYNC_CHECK_TYPE g_TimeSyncCheck;
+#endif
+
+#pragma CODE_SECTION(f_TimeSync_ToLocal, "ComexHotCode");
+
+
+
+/*
+** f_TimeSync_Init
+** Empty window, no fit */
+void f_TimeSync_Init( TIME_SYNC_TYPE *S )
+{
+    memset( S, 0, sizeof(TIME_SYNC_TYPE) );
+    S->Rate = 1.0f;
+} /* End f_TimeSync_Init */
+
+
+
+/*
+** f_TimeSync_Restart
+** Drop the window, keep the statistics and the unwrapping */
+static void f_TimeSync_Restart( TIME_SYNC_TYPE *S )
+{
+    S->Head    = 0;
+    S->Count   = 0;
+    S->AccN    = 0;
+    S->Rejects = 0;
+    S->Valid   = FALSE;
+    S->Stats.Restarts++;
+} /* End f_TimeSync_Restart */
+
+
+
+/*
+** f_TimeSync_Fit
+** Least squares line through the window, relative to the
+** newest pair. Centred sums, so no cancellation in single float */
+static void f_TimeSync_Fit( TIME_SYNC_TYPE *S )
+{
+    Uint16 i, Slot, Newest;
+    float x, y, Mx, My, Sxx, Sxy, r, Srr, Rmax;
+
+    Newest = (S->Head - 1) & (TIME_SYNC_DEPTH-1);
+
+    Mx = 0; My = 0;
+    for( i=0; i<S->Count; i++ )
+    {
+        Slot = (S->Head - 1 - i) & (TIME_SYNC_DEPTH-1);
+        Mx += -(float)(int32_t)(S->Imu[Newest] - S->Imu[Slot]);
+        My += -(float)(int64_t)(S->Local[Newest] - S->Local[Slot]) * (1.0f/IPC_TICKS_PER_US);
+    }
+    Mx /= S->Count;
+    My /= S->Count;
+
+    Sxx = 0; Sxy = 0;
+    for( i=0; i<S->Count; i++ )
+    {
+        Slot = (S->Head - 1 - i) & (TIME_SYNC_DEPTH-1);
+        x = -(float)(int32_t)(S->Imu[Newest] - S->Imu[Slot]) - Mx;
+        y = -(float)(int64_t)(S->Local[Newest] - S->Local[Slot]) * (1.0f/IPC_TICKS_PER_US) - My;
+        Sxx += x*x;
+        Sxy += x*y;
+    }
+    if( Sxx <= 0.0f ) { return; }   /* All pairs at one IMU time */
+
+    S->Rate      = Sxy / Sxx;
+    S->Offset_us = My - S->Rate*Mx;
+    S->RefImu    = S->Imu[Newest];
+    S->RefLocal  = S->Local[Newest];
+    S->Valid     = TRUE;
+
+    /* Residuals, for the statistics */
+    Srr = 0; Rmax = 0;
+    for( i=0; i<S->Count; i++ )
+    {
+        Slot = (S->Head - 1 - i) & (TIME_SYNC_DEPTH-1);
+        x = -(float)(int32_t)(S->Imu[Newest] - S->Imu[Slot]);
+        y = -(float)(int64_t)(S->Local[Newest] - S->Local[Slot]) * (1.0f/IPC_TICKS_PER_US);
+        r = fabsf( y - (S->Offset_us + S->Rate*x) );
+        Srr += r*r;
+        if( r > Rmax ) { Rmax = r; }
+    }
+    S->Stats.SkewPpm     = (S->Rate - 1.0f)*1.0e6f;
+    S->Stats.ResidRms_us = CMATH_SQRT( Srr / S->Count );
+    S->Stats.ResidMax_us = Rmax;
+} /* End f_TimeSync_Fit */
+
+
+
+/*
+** f_TimeSync_ToLocal
+** IPC counter at IMU time Imu_us (unwrapped), on the current fit.
+** Only meaningful once S->Valid */
+Uint64 f_TimeSync_ToLocal( TIME_SYNC_TYPE *S, Uint64 Imu_us )
+{
+    float dt = (float)(int32_t)(Imu_us - S->RefImu);
+    float us = S->Offset_us + S->Rate*dt;
+
+    return( S->RefLocal + (int64_t)(us*IPC_TICKS_PER_US) );
+} /* End f_TimeSync_ToLocal */
+
+
+
+/*
+** f_TimeSync_Unwrap
+** 32 bit IMU stamp to a 64 bit time, counting wraps */
+static Uint64 f_TimeSync_Unwrap( TIME_SYNC_TYPE *S, Uint32 ImuStamp_us )
+{
+    if( (S->Stats.Pairs > 0) && (ImuStamp_us < S->LastRaw) &&
+        (S->LastRaw - ImuStamp_us > 0x80000000UL) )
+    {
+        S->Wraps++;
+    }
+    S->LastRaw = ImuStamp_us;
+
+    return( ((Uint64)S->Wraps << 32) | ImuStamp_us );
+} /* End f_TimeSync_Unwrap */
+
+
+
+/*
+** f_TimeSync_Add
+** One (IMU time, arrival) pair into the average of the current
+** window pair. Once that spans TIME_SYNC_SPACING_US it goes into
+** the window and the line is refit.
+** Returns FALSE if the pair was skipped, as a repeat of the last
+** stamp or as an outlier */
+bool f_TimeSync_Add( TIME_SYNC_TYPE *S, Uint32 ImuStamp_us, Uint64 Local )
+{
+    bool   First = (S->Stats.Pairs == 0);
+    Uint64 Last  = ((Uint64)S->Wraps << 32) | S->LastRaw;
+    Uint64 Imu   = f_TimeSync_Unwrap( S, ImuStamp_us );
+    float Resid;
+
+    S->Stats.Pairs++;
+
+    /* Same IMU time again (a resent sample): nothing new to fit */
+    if( (First == FALSE) && (Imu == Last) )
+    {
+        S->Stats.Duplicates++;
+        return( FALSE );
+    }
+
+    /* IMU clock went back: it was reset */
+    if( (First == FALSE) && (Imu < Last) )
+    {
+        f_TimeSync_Restart( S );
+    }
+
+    if( S->Valid )
+    {
+        Resid = (float)(int64_t)(Local - f_TimeSync_ToLocal( S, Imu )) * (1.0f/IPC_TICKS_PER_US);
+        if( fabsf( Resid ) > TIME_SYNC_OUTLIER_US )
+        {
+            S->Stats.Rejected++;
+            if( ++S->Rejects < TIME_SYNC_MAX_REJECTS ) { return( FALSE ); }
+            f_TimeSync_Restart( S );
+        }
+    }
+    S->Rejects = 0;
+
+    if( S->AccN == 0 )
+    {
+        S->AccImu0   = Imu;
+        S->AccLocal0 = Local;
+        S->AccImu    = 0;
+        S->AccLocal  = 0;
+    }
+    S->AccImu   += (Uint32)(Imu - S->AccImu0);
+    S->AccLocal += Local - S->AccLocal0;
+    S->AccN++;
+
+    if( Imu - S->AccImu0 < TIME_SYNC_SPACING_US ) { return( TRUE ); }
+
+    /* Interval complete, its mean is the next window pair */
+    S->Imu[S->Head]   = S->AccImu0   + S->AccImu/S->AccN;
+    S->Local[S->Head] = S->AccLocal0 + S->AccLocal/S->AccN;
+    S->Head = (S->Head + 1) & (TIME_SYNC_DEPTH-1);
+    if( S->Count < TIME_SYNC_DEPTH ) { S->Count++; }
+    S->AccN = 0;
+
+    if( S->Count >= TIME_SYNC_MIN_PAIRS ) { f_TimeSync_Fit( S ); }
+
+    return( TRUE );
+} /* End f_TimeSync_Add */
+
+
+
+/*
+** f_TimeSync_Sample
+** Feed a decoded sample's stamps to S and give it its sample
+** time on our clock. Samples without an IMU stamp, or before
+** the fit is up, keep SampleStamp = RxFirstStamp */
+void f_TimeSync_Sample( TIME_SYNC_TYPE *S, DATA_TYPE *Data )
+{
+    Uint64 Imu;
+
+    if( Data->HasImuStamp == FALSE ) { return; }
+
+    f_TimeSync_Add( S, Data->ImuStamp_us, Data->RxFirstStamp );
+    if( S->Valid == FALSE ) { return; }
+
+    Imu = ((Uint64)S->Wraps << 32) | Data->ImuStamp_us;
+    Data->SampleStamp = f_TimeSync_ToLocal( S, Imu ) - TIME_SYNC_DELAY_US*IPC_TICKS_PER_US;
+} /* End f_TimeSync_Sample */
+
+
+
+#if COMEX_INSTRUMENT >= INSTR_BENCH
+/*
+** f_TimeSync_Check
+** Run nPairs synthetic samples (100 Hz) through an estimator.
+** Our clock runs TIME_SYNC_CHECK_PPM fast against the IMU, each
+** arrival is 1 ms late plus up to TIME_SYNC_CHECK_JITTER_US of
+** jitter, and the IMU stamps wrap part way. Once the fit is up,
+** every mapped stamp is compared with the jitter free
+** arrival plus the mean jitter, which is what the fit should
+** return (TIME_SYNC_DELAY_US aside) */
+void f_TimeSync_Check( Uint16 nPairs )
+{
+    Uint16 i;
+    static TIME_SYNC_TYPE S;   /* Too big for the stack */
+    DATA_TYPE Data;
+    Uint32 Imu, Rand, Jitter;
+    Uint64 Local0, Truth, Start, Cycles;
+    float Err, MaxErr;
+
+    f_TimeSync_Init( &S );
+    memset( &Data, 0, sizeof(DATA_TYPE) );
+
+    Imu    = 0xFFFFFFFFUL - 5000000UL;  /* Wraps after 5 s */
+    Local0 = 1000000000ULL;
+    Rand   = 12345;
+    Cycles = 0;
+    MaxErr = 0;
+
+    for( i=0; i<nPairs; i++ )
+    {
+        Imu += 10000UL;
+
+        /* Arrival on our clock, IMU time scaled by the skew */
+        Truth = (Uint64)i*10000UL*IPC_TICKS_PER_US;
+        Truth = Local0 + Truth + Truth*TIME_SYNC_CHECK_PPM/1000000UL + 1000UL*IPC_TICKS_PER_US;
+        Rand   = Rand*1103515245UL + 12345UL;
+        Jitter = (Rand >> 16) % (TIME_SYNC_CHECK_JITTER_US + 1);
+
+        Data.HasImuStamp  = TRUE;
+        Data.ImuStamp_us  = Imu;
+        Data.RxFirstStamp = Truth + Jitter*IPC_TICKS_PER_US;
+        Data.SampleStamp  = Data.RxFirstStamp;
+
+        Start = ReadIpcTimer();
+        f_TimeSync_Sample( &S, &Data );
+        Cycles += ReadIpcTimer() - Start;
+
+        if( S.Valid )
+        {
+            Truth += (TIME_SYNC_CHECK_JITTER_US/2)*IPC_TICKS_PER_US;
+            Err = fabsf( (float)(int64_t)(Data.SampleStamp - Truth) ) * (1.0f/IPC_TICKS_PER_US);
+            if( Err > MaxErr ) { MaxErr = Err; }
+        }
+    }
+
+    g_TimeSyncCheck.Pairs         = nPairs;
+    g_TimeSyncCheck.SkewPpm       = (float)TIME_SYNC_CHECK_PPM;
+    g_TimeSyncCheck.SkewErrPpm    = S.Stats.SkewPpm - (float)TIME_SYNC_CHECK_PPM;
+    g_TimeSyncCheck.MaxErr_us     = MaxErr;
+    g_TimeSyncCheck.ResidRms_us   = S.Stats.ResidRms_us;
+    g_TimeSyncCheck.Restarts      = S.Stats.Restarts;
+    g_TimeSyncCheck.CyclesPerPair = (nPairs > 0) ? (Uint32)(Cycles / nPairs) : 0;
+} /* End f_TimeSync_Check */
+#endif
@@ -0,0 +1,72 @@
+#!/usr/bin/env python
+#
+# arq_sim.py
+#
+#  Goodput and added latency of the selective retransmission window
+#  for other windows, hold times and loss rates than the target's:
+#  builds the real Link_Arq.c with tools/host/arq_check.c
+#  (host_build.py) and runs f_Arq_Check, so its table is what
+#  f_Arq_Check leaves in g_ArqCheck on target with the same settings:
+#
+#      python tools/arq_sim.py
+#      python tools/arq_sim.py --window 8 --loss 200000 --csv
+#
+#  Losses come from one xorshift32 generator across the loss rates,
+#  as on target, so a rate's figures depend on the rates before it.
+#
+
+import sys
+import argparse
+
+import host_build
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Goodput and added latency of the ARQ window on a lossy link')
+    ap.add_argument('--packets', type=int, default=1000, help='new packets per loss rate (f_Arq_Check)')
+    ap.add_argument('--loss', type=int, nargs='+', default=[10000, 50000, 100000],
+                    help='packet loss, ppm (ARQ_CHECK_LOSS)')
+    ap.add_argument('--window', type=int, default=4, help='ARQ_WINDOW, a power of 2')
+    ap.add_argument('--hold-us', type=int, default=50000, help='ARQ_HOLD_US')
+    ap.add_argument('--max-naks', type=int, default=2, help='ARQ_MAX_NAKS')
+    ap.add_argument('--slot-us', type=int, default=2000, help='request interval (ARQ_CHECK_SLOT_US)')
+    ap.add_argument('--csv', action='store_true', help='CSV instead of a table')
+    args = ap.parse_args()
+
+    if args.window < 1 or args.window & (args.window - 1):
+        ap.error('--window must be a power of 2')
+    if not 0 < args.packets <= 0xFFFF:
+        ap.error('--packets is a Uint16')
+    if any(not 0 <= ppm < 1000000 for ppm in args.loss):
+        ap.error('--loss is 0..999999 ppm')
+
+    config = {
+        'COMEX_USE_ARQ': 1,
+        'COMEX_INSTRUMENT': 'INSTR_BENCH',
+        'ARQ_WINDOW': args.window,
+        'ARQ_HOLD_US': '%dUL' % args.hold_us,
+        'ARQ_MAX_NAKS': args.max_naks,
+        'ARQ_CHECK_SLOT_US': '%dUL' % args.slot_us,
+        'ARQ_CHECK_NLOSS': len(args.loss),
+        'ARQ_CHECK_LOSS': '{ %s }' % ', '.join('%dUL' % ppm for ppm in args.loss),
+        'PKT_POOL_DEPTH': 'RX_FRAME_DEPTH + ARQ_WINDOW + 1',
+    }
+    exe = host_build.build('arq_check', ['Link_Arq.c'], config)
+
+    if args.csv:
+        print('loss_ppm,plain,arq,lost,naks,added_mean_us,added_max_us')
+    else:
+        print('%9s %7s %7s %5s %5s %10s %10s' % ('loss ppm', 'plain', 'ARQ', 'lost', 'NAKs', 'mean us', 'max us'))
+    for line in host_build.run(exe, [args.packets]):
+        v = line.split()
+        ppm, g0, g1, lost, naks, mean, worst = (int(v[0]), float(v[1]), float(v[2]), int(v[3]),
+                                                int(v[4]), float(v[5]), int(v[6]))
+        if args.csv:
+            print('%d,%.4f,%.4f,%d,%d,%.1f,%d' % (ppm, g0, g1, lost, naks, mean, worst))
+        else:
+            print('%9d %7.3f %7.3f %5d %5d %10.1f %10d' % (ppm, g0, g1, lost, naks, mean, worst))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
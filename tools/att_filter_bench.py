@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+#
+# att_filter_bench.py
+#
+#  Host benchmark of the attitude filter: builds the real
+#  Attitude_Filter.c with tools/host/att_filter_bench.c
+#  (host_build.py) and runs f_AttFilter_Benchmark, then has the filter
+#  track a yaw turning through +-180 at a constant rate:
+#
+#      python tools/att_filter_bench.py
+#      python tools/att_filter_bench.py --kp 2 --ki 1 --rate-dps 90 --seconds 60
+#
+#  The host build takes the libm side of the CMATH_ macros (tmu=0),
+#  so the time is the portable path on this PC, not C28x cycles. The
+#  TMU against libm comparison is g_AttFilterBench on the target,
+#  built with and without --tmu_support=tmu0.
+#  Fails (exit 1) if the learned rate or the estimate 5 ms past a
+#  sample is off by more than the tolerances.
+#
+
+import sys
+import argparse
+
+import host_build
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Host benchmark of the attitude filter')
+    ap.add_argument('--updates', type=int, default=10000, help='correct/estimate cycles per benchmark run')
+    ap.add_argument('--repeats', type=int, default=5, help='benchmark runs, the fastest is kept')
+    ap.add_argument('--kp', type=float, help='ATT_FILTER_KP (1/s)')
+    ap.add_argument('--ki', type=float, help='ATT_FILTER_KI (1/s^2)')
+    ap.add_argument('--rate-dps', type=float, default=30.0, help='yaw rate tracked (deg/s)')
+    ap.add_argument('--seconds', type=float, default=20.0, help='tracking run length, 50 Hz samples')
+    ap.add_argument('--rate-tol', type=float, default=0.01, help='learned rate tolerance (deg/s)')
+    ap.add_argument('--est-tol', type=float, default=0.01, help='estimate tolerance (deg)')
+    args = ap.parse_args()
+
+    if not 0 < args.updates <= 0xFFFF:
+        ap.error('--updates is a Uint16')
+
+    config = {'COMEX_USE_ATT_FILTER': 1, 'COMEX_INSTRUMENT': 'INSTR_BENCH'}
+    if args.kp is not None:
+        config['ATT_FILTER_KP'] = '%rf' % args.kp
+    if args.ki is not None:
+        config['ATT_FILTER_KI'] = '%rf' % args.ki
+    exe = host_build.build('att_filter_bench', ['Attitude_Filter.c'], config)
+
+    result = {}
+    for line in host_build.run(exe, [args.updates, args.repeats, args.rate_dps, args.seconds]):
+        name, value = line.split('=')
+        result[name] = float(value)
+        print('%-18s %s' % (name, value))
+
+    failed = []
+    if result['rate_err_dps'] > args.rate_tol:
+        failed.append('rate_err_dps')
+    if result['est_err_deg'] > args.est_tol:
+        failed.append('est_err_deg')
+    if failed:
+        print('FAILED: ' + ', '.join(failed))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,127 @@
+#!/usr/bin/env python
+#
+# att_post_ref.py
+#
+#  Host reference of the attitude post-processing: builds the real
+#  Attitude_Post.c with COMEX_USE_CLA_POST 0 (f_AttPost_Run on
+#  f_AttPost_Reference, the C28x copy of Cla1Task1) and
+#  Attitude_Math.c with tools/host/att_post_ref.c (host_build.py).
+#
+#  Without --input it sweeps roll and yaw through +-180 for a few
+#  turns, in Q7 (type 1) and float (type 2) packets, and checks that
+#  unfiltered output is the input folded into [-180, 180), that the
+#  filtered output never steps further than the input did (no fold
+#  or unwrap glitch) and that the quaternions are unit length:
+#
+#      python tools/att_post_ref.py
+#      python tools/att_post_ref.py --alpha 0.2 --packets 20000
+#
+#  With --input it runs packets from a file, one per line
+#  "PacketType Roll Pitch Yaw" (deg, commas allowed) or "restart",
+#  and prints the result, e.g. to set beside a capture of the CLA:
+#
+#      python tools/att_post_ref.py --input packets.txt --csv
+#
+
+import sys
+import math
+import argparse
+
+import host_build
+
+
+COLUMNS = ('roll', 'pitch', 'yaw', 'qw', 'qx', 'qy', 'qz')
+
+
+def fold(a):
+    """Into [-180, 180)"""
+    return (a + 180.0) % 360.0 - 180.0
+
+
+def sweep(n, ptype):
+    """Packets with roll and yaw turning the opposite ways, pitch swinging"""
+    rows = []
+    for k in range(n):
+        rows.append((ptype, fold(-1.7 * k + 150.0), 30.0 * math.sin(k * 0.05), fold(2.5 * k - 170.0)))
+    return rows
+
+
+def run(exe, args, rows):
+    lines = ['restart' if r == 'restart' else '%d %.6f %.6f %.6f' % r for r in rows]
+    out = []
+    for line in host_build.run(exe, [args.mount_yaw, args.alpha], lines):
+        out.append(None if line == 'none' else [float(v) for v in line.split()])
+    return out
+
+
+def check(exe, args):
+    """The sweep in both packet types, returns the number of failures"""
+    failures = 0
+    print('%4s %6s %12s %12s %12s' % ('type', 'alpha', 'fold err', 'step excess', '|q|-1'))
+
+    for ptype, tol in ((1, 0.5 / 128.0), (2, 1.0e-3)):
+        rows = sweep(args.packets, ptype)
+        for alpha in (1.0, args.alpha):
+            a = argparse.Namespace(mount_yaw=0.0, alpha=alpha)
+            out = run(exe, a, rows)
+
+            fold_err = 0.0
+            step_excess = 0.0
+            qerr = 0.0
+            for k, (row, res) in enumerate(zip(rows, out)):
+                if alpha == 1.0:
+                    for i in (0, 2):
+                        fold_err = max(fold_err, abs(fold(res[i] - row[1 + i])))
+                    if not (-180.0 <= res[0] < 180.0 and -180.0 <= res[2] < 180.0):
+                        fold_err = max(fold_err, 360.0)
+                if k > 0:
+                    for i in (0, 2):
+                        step_in = abs(fold(row[1 + i] - rows[k - 1][1 + i]))
+                        step_out = abs(fold(res[i] - out[k - 1][i]))
+                        step_excess = max(step_excess, step_out - step_in)
+                qerr = max(qerr, abs(math.sqrt(sum(q * q for q in res[3:7])) - 1.0))
+
+            bad = fold_err > tol or step_excess > tol or qerr > 1.0e-5
+            failures += bad
+            print('%4d %6.2f %12s %12.6f %12.2e%s' % (ptype, alpha, '%.6f' % fold_err if alpha == 1.0 else '-',
+                                                       step_excess, qerr, '  FAILED' if bad else ''))
+    return failures
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Host reference of the attitude post-processing')
+    ap.add_argument('--input', help='packets to run, one per line')
+    ap.add_argument('--mount-yaw', type=float, default=0.0, help='ATT_MOUNT_YAW (deg), --input only')
+    ap.add_argument('--alpha', type=float, default=0.5, help='ATT_POST_ALPHA')
+    ap.add_argument('--packets', type=int, default=1000, help='packets per sweep')
+    ap.add_argument('--csv', action='store_true', help='CSV instead of a table (--input)')
+    args = ap.parse_args()
+
+    exe = host_build.build('att_post_ref', ['Attitude_Post.c', 'Attitude_Math.c'],
+                           {'COMEX_USE_CLA_POST': 0, 'COMEX_CLA_CHECK': 0})
+
+    if not args.input:
+        return 1 if check(exe, args) else 0
+
+    rows = []
+    with open(args.input) as f:
+        for line in f:
+            v = line.replace(',', ' ').split()
+            if v and v[0] == 'restart':
+                rows.append('restart')
+            elif len(v) == 4:
+                rows.append((int(v[0]), float(v[1]), float(v[2]), float(v[3])))
+
+    print((','.join(COLUMNS)) if args.csv else ' '.join('%12s' % c for c in COLUMNS))
+    for res in run(exe, args, rows):
+        if res is None:
+            print('none')
+        elif args.csv:
+            print(','.join('%.6f' % v for v in res))
+        else:
+            print(' '.join('%12.6f' % v for v in res))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,81 @@
+#!/usr/bin/env python
+#
+# att_predict_sim.py
+#
+#  Host simulator of the latency compensation: builds the real
+#  Attitude_Predict.c with tools/host/att_predict_sim.c
+#  (host_build.py). The IMU samples a known trajectory (roll and
+#  pitch swinging, yaw turning through +-180), each sample arrives
+#  --latency-us later, and a control tick every --control-us asks the
+#  predictor for the attitude now. Prints the error against the
+#  truth for HOLD, LINEAR and RATE, then f_AttPredict_Check's own
+#  noise free figures (ATT_PREDICT_MODE, queries 5 ms past a sample):
+#
+#      python tools/att_predict_sim.py
+#      python tools/att_predict_sim.py --period-us 10000 --latency-us 2000
+#      python tools/att_predict_sim.py --noise-deg 0.1 --jitter-us 500 --depth 8
+#
+#  The default latency is about a 20 byte packet at 9600 baud.
+#
+
+import sys
+import argparse
+
+import host_build
+
+
+AXES = ('roll', 'pitch', 'yaw')
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Host simulator of the attitude predictor')
+    ap.add_argument('--seconds', type=float, default=20.0, help='simulated time')
+    ap.add_argument('--period-us', type=int, default=25000, help='IMU sample period')
+    ap.add_argument('--latency-us', type=int, default=21000, help='sample to arrival')
+    ap.add_argument('--jitter-us', type=int, default=0, help='stamp error, uniform 0..jitter')
+    ap.add_argument('--noise-deg', type=float, default=0.0, help='angle noise, uniform +-noise')
+    ap.add_argument('--control-us', type=int, default=1000, help='control tick')
+    ap.add_argument('--yaw-dps', type=float, default=90.0, help='yaw rate (deg/s)')
+    ap.add_argument('--depth', type=int, help='ATT_PREDICT_DEPTH, a power of 2')
+    ap.add_argument('--max-us', type=int, help='ATT_PREDICT_MAX_US')
+    ap.add_argument('--csv', action='store_true', help='CSV instead of a table')
+    args = ap.parse_args()
+
+    if args.period_us <= 0 or args.control_us <= 0:
+        ap.error('--period-us and --control-us must be positive')
+
+    config = {'COMEX_USE_ATT_PREDICT': 1, 'COMEX_INSTRUMENT': 'INSTR_BENCH'}
+    if args.depth is not None:
+        if args.depth < 2 or args.depth & (args.depth - 1):
+            ap.error('--depth must be a power of 2, at least 2')
+        config['ATT_PREDICT_DEPTH'] = args.depth
+    if args.max_us is not None:
+        config['ATT_PREDICT_MAX_US'] = '%dUL' % args.max_us
+    exe = host_build.build('att_predict_sim', ['Attitude_Predict.c'], config)
+
+    out = host_build.run(exe, [args.seconds, args.period_us, args.latency_us, args.jitter_us,
+                               args.noise_deg, args.control_us, args.yaw_dps])
+
+    head = (['mode'] + ['mean ' + a for a in AXES] + ['max ' + a for a in AXES] +
+            ['clamped', 'restarts'])
+    if args.csv:
+        print(','.join(h.replace(' ', '_') for h in head))
+    else:
+        print('%-7s' % head[0] + ''.join('%11s' % h for h in head[1:]))
+
+    for line in out:
+        v = line.split()
+        if v[0] == 'check':
+            # f_AttPredict_Check: Samples and Lead_us in the last two columns
+            if not args.csv:
+                print('check: %s samples, queries %s us past a sample' % (v[7], v[8]))
+            v = v[:7] + ['-', '-']
+        if args.csv:
+            print(','.join(v))
+        else:
+            print('%-7s' % v[0] + ''.join('%11s' % x for x in v[1:]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
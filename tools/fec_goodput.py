@@ -0,0 +1,55 @@
+#!/usr/bin/env python
+#
+# fec_goodput.py
+#
+#  Expected goodput of the IMU link, plain and with the Hamming(8,4)
+#  FEC mode (Fec.c), against bit error rate. Goodput is packets
+#  through intact per character time, relative to a clean plain
+#  link, the same measure f_Fec_Benchmark leaves in g_FecBench, so
+#  the two can be set side by side:
+#
+#      python tools/fec_goodput.py
+#      python tools/fec_goodput.py --bytes 13 --csv > q7.csv
+#
+#  A plain packet needs every bit right. A coded packet needs at
+#  most one bit error in each of its codewords. Data bits only,
+#  start/stop bit errors (framing errors) are left out.
+#
+
+import sys
+import argparse
+
+
+def plain(p, nbytes):
+    return (1.0 - p) ** (8 * nbytes)
+
+
+def coded(p, nbytes):
+    word = (1.0 - p) ** 8 + 8 * p * (1.0 - p) ** 7
+    return word ** (2 * nbytes) / 2.0
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Goodput of plain and FEC coded packets against BER')
+    ap.add_argument('--bytes', type=int, default=19, help='packet, length to checksum (type 2: 19)')
+    ap.add_argument('--ber', type=float, nargs='*',
+                    default=[1e-5, 1e-4, 3e-4, 1e-3, 3e-3, 1e-2, 3e-2],
+                    help='bit error rates')
+    ap.add_argument('--csv', action='store_true', help='CSV instead of a table')
+    args = ap.parse_args()
+
+    if args.csv:
+        print('ber,plain,fec')
+    else:
+        print('%10s %8s %8s' % ('BER', 'plain', 'FEC'))
+    for p in args.ber:
+        g0, g1 = plain(p, args.bytes), coded(p, args.bytes)
+        if args.csv:
+            print('%g,%.4f,%.4f' % (p, g0, g1))
+        else:
+            print('%10g %8.3f %8.3f%s' % (p, g0, g1, '  <- FEC' if g1 > g0 else ''))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,8 @@
+/*
+ * F2837xD_Cla_typedefs.h (host)
+ *
+ *  COMEX_Cla.h only needs the C28x types, which the host
+ *  F28x_Project.h already gives.
+ */
+
+#include "F28x_Project.h"
@@ -0,0 +1,55 @@
+/*
+ * F28x_Project.h (host)
+ *
+ *  Stands in for the C2000Ware header when repo sources are built
+ *  with the PC's C compiler (tools/host_build.py). Only what the
+ *  host-built files use: the C28x types, the IPC counter, the IPC
+ *  flags and the message RAMs (host_shim.c).
+ *  sizeof counts bytes here, not 16 bit words, and char is 8 bits,
+ *  so code tied to the C28x word layout (packet unpacking, the CLA
+ *  task, the SCI drivers) is not built on the host.
+ */
+
+#ifndef F28X_PROJECT_H
+#define F28X_PROJECT_H
+
+#include <stdint.h>
+
+typedef int16_t  int16;
+typedef int32_t  int32;
+typedef int64_t  int64;
+typedef uint16_t Uint16;
+typedef uint32_t Uint32;
+typedef uint64_t Uint64;
+typedef float    float32;
+typedef double   float64;
+
+#define __interrupt
+#define EALLOW
+#define EDIS
+
+/* IPC counter, 100 ticks per us like SYSCLK (host_shim.c) */
+Uint64 ReadIpcTimer( void );
+
+/* IPC flags of one direction: the producer's IPCFLG is the
+** consumer's IPCSTS */
+struct IPC_REGS_HOST
+{
+    union { Uint32 all; } IPCFLG;
+};
+#define IPCSTS IPCFLG
+extern volatile struct IPC_REGS_HOST IpcRegs;
+
+#define SendIpcFlag(Flag) __atomic_fetch_or( &IpcRegs.IPCFLG.all, (Uint32)1 << (Flag), __ATOMIC_SEQ_CST )
+#define AckIpcFlag(Flag)  __atomic_fetch_and( &IpcRegs.IPCFLG.all, ~((Uint32)1 << (Flag)), __ATOMIC_SEQ_CST )
+
+/* Message RAMs, per thread so a producer and a consumer thread
+** each see their own send RAM as the other's receive RAM.
+** MSG_RAM_SIZE is the device's 1K words, in bytes */
+extern __thread void *g_HostSendRam;
+extern __thread void *g_HostRecvRam;
+#define SEND_MSG_RAM g_HostSendRam
+#define RECV_MSG_RAM g_HostRecvRam
+#define MSG_RAM_SIZE (0x400*2)
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * arq_check.c
+ *
+ *  Host run of f_Arq_Check (Link_Arq.c built with COMEX_USE_ARQ and
+ *  COMEX_INSTRUMENT INSTR_BENCH), driven by tools/arq_sim.py, which
+ *  sets the window, hold time and loss rates. Prints g_ArqCheck, one
+ *  line per loss rate:
+ *
+ *      LossPpm PlainGoodput ArqGoodput Lost Naks AddedMean_us AddedMax_us
+ *
+ *      arq_check Packets
+ */
+
+#include <stdlib.h>
+#include "COMEX_Proj.h"
+
+
+
+int main( int argc, char **argv )
+{
+    Uint16 k;
+
+    if( argc != 2 ) { printf( "usage: arq_check Packets\n" ); return( 2 ); }
+
+    f_Arq_Check( (Uint16)strtoul( argv[1], NULL, 0 ) );
+
+    for( k=0; k<ARQ_CHECK_NLOSS; k++ )
+    {
+        printf( "%lu %.6f %.6f %u %u %.3f %lu\n",
+                (unsigned long)g_ArqCheck.LossPpm[k],
+                g_ArqCheck.PlainGoodput[k], g_ArqCheck.ArqGoodput[k],
+                g_ArqCheck.Lost[k], g_ArqCheck.Naks[k],
+                g_ArqCheck.AddedMean_us[k], (unsigned long)g_ArqCheck.AddedMax_us[k] );
+    }
+
+    return( 0 );
+} /* End main */
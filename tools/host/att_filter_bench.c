@@ -0,0 +1,86 @@
+/*
+ * att_filter_bench.c
+ *
+ *  Host run of the attitude filter (Attitude_Filter.c built with
+ *  COMEX_INSTRUMENT INSTR_BENCH), driven by tools/att_filter_bench.py.
+ *  Runs f_AttFilter_Benchmark Repeats times and keeps the fastest,
+ *  then tracks a yaw turning at Rate_dps through ±180 for Seconds at
+ *  50 Hz and reports how well the filter learned the rate and how far
+ *  an estimate 5 ms past a sample is from the truth.
+ *  Prints name=value lines.
+ *
+ *      att_filter_bench Updates Repeats Rate_dps Seconds
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "COMEX_Proj.h"
+
+#define BENCH_PERIOD_US   20000UL   /* 50 Hz, as f_AttFilter_Benchmark */
+#define BENCH_AHEAD_US    5000UL
+
+
+
+/*
+** f_Fold
+** Into [-180,180) (deg) */
+static float f_Fold( double Angle )
+{
+    return( (float)(Angle - 360.0*floor( (Angle + 180.0)/360.0 )) );
+} /* End f_Fold */
+
+
+
+int main( int argc, char **argv )
+{
+    Uint32 i, Repeats, Samples, Best;
+    float Rate, Err, EstErr, RateErr;
+    double Truth;
+    Uint64 Stamp;
+    ATT_FILTER_TYPE F;
+    DATA_TYPE Meas, Out;
+
+    if( argc != 5 ) { printf( "usage: att_filter_bench Updates Repeats Rate_dps Seconds\n" ); return( 2 ); }
+
+    Repeats = strtoul( argv[2], NULL, 0 );
+    Rate    = strtof( argv[3], NULL );
+    Samples = (Uint32)(strtof( argv[4], NULL )*1.0e6f/BENCH_PERIOD_US);
+
+    Best = 0xFFFFFFFFUL;
+    for( i=0; i<Repeats; i++ )
+    {
+        f_AttFilter_Benchmark( (Uint16)strtoul( argv[1], NULL, 0 ) );
+        if( g_AttFilterBench.CyclesPerUpdate < Best ) { Best = g_AttFilterBench.CyclesPerUpdate; }
+    }
+    printf( "updates=%u\n", g_AttFilterBench.Updates );
+    printf( "tmu=%u\n", g_AttFilterBench.Tmu );
+    printf( "ticks_per_update=%lu\n", (unsigned long)Best );
+    printf( "ns_per_update=%.1f\n", Best*1000.0/IPC_TICKS_PER_US );
+
+    /* Tracking, the error over the second half once the rate is learned */
+    f_AttFilter_Init( &F, ATT_FILTER_KP, ATT_FILTER_KI );
+    memset( &Meas, 0, sizeof(DATA_TYPE) );
+    EstErr = 0;
+    Stamp  = 0;
+
+    for( i=0; i<Samples; i++ )
+    {
+        Stamp     += BENCH_PERIOD_US*IPC_TICKS_PER_US;
+        Truth      = Rate*(double)Stamp/(IPC_TICKS_PER_US*1.0e6);
+        Meas.Roll  = 10.0f;
+        Meas.Pitch = -5.0f;
+        Meas.Yaw   = f_Fold( Truth );
+
+        f_AttFilter_Correct( &F, &Meas, Stamp );
+        f_AttFilter_Estimate( &F, Stamp + BENCH_AHEAD_US*IPC_TICKS_PER_US, &Out );
+
+        Err = fabsf( f_Fold( Out.Yaw - (Truth + Rate*BENCH_AHEAD_US*1.0e-6) ) );
+        if( (i >= Samples/2) && (Err > EstErr) ) { EstErr = Err; }
+    }
+    RateErr = fabsf( F.Rate[2]*(180.0f/3.14159265f) - Rate );
+
+    printf( "rate_err_dps=%.6f\n", RateErr );
+    printf( "est_err_deg=%.6f\n", EstErr );
+
+    return( 0 );
+} /* End main */
@@ -0,0 +1,117 @@
+/*
+ * att_post_ref.c
+ *
+ *  Host run of the attitude post-processing reference path
+ *  (Attitude_Post.c built with COMEX_USE_CLA_POST 0, so
+ *  f_AttPost_Run loads the packet and calls f_AttPost_Reference),
+ *  driven by tools/att_post_ref.py.
+ *  Reads one packet per line on stdin,
+ *
+ *      PacketType Roll Pitch Yaw      (deg; type 1 is sent as Q7)
+ *      restart                        (link rebuilt, State.Count = 0)
+ *
+ *  packs it the way the IMU sends it and prints the result per
+ *  packet: roll pitch yaw qw qx qy qz.
+ *
+ *      att_post_ref MountYaw Alpha
+ */
+
+#include <stdlib.h>
+#include "COMEX_Proj.h"
+
+
+
+/*
+** f_UnpackFloat_s32
+** Host form of the IO_Helpers.c unpacker, which writes the C28x's
+** 16 bit chars: 4 bytes, big endian, bit for bit */
+void f_UnpackFloat_s32( unsigned char *Packet, float *Output )
+{
+    Uint32 Bits = ((Uint32)Packet[0] << 24) | ((Uint32)Packet[1] << 16) |
+                  ((Uint32)Packet[2] << 8)  |  (Uint32)Packet[3];
+
+    memcpy( Output, &Bits, sizeof(float) );
+} /* End f_UnpackFloat_s32 */
+
+
+
+/*
+** f_UnpackInt_u16
+** As IO_Helpers.c */
+void f_UnpackInt_u16( unsigned char *Packet, unsigned int *Output )
+{
+    *Output = (Packet[0] << 8) | (Packet[1]);
+} /* End f_UnpackInt_u16 */
+
+
+
+/*
+** f_Pack
+** Angles into Response->Buffer as the IMU sends them */
+static void f_Pack( RESPONSE_TYPE *Response, Uint16 PacketType, float *Angle )
+{
+    Uint16 i;
+    Uint32 Bits;
+    int16 Q7;
+
+    memset( Response, 0, sizeof(RESPONSE_TYPE) );
+    Response->PacketType = PacketType;
+
+    for( i=0; i<3; i++ )
+    {
+        if( PacketType == 1 )
+        {
+            Q7 = (int16)lrintf( Angle[i]/CLA_Q7_SCALE );
+            Response->Buffer[SFLOAT*i]   = (Uint16)Q7 >> 8;
+            Response->Buffer[SFLOAT*i+1] = (Uint16)Q7 & 0xFF;
+        }
+        else
+        {
+            memcpy( &Bits, &Angle[i], sizeof(float) );
+            Response->Buffer[SFLOAT*2*i]   = Bits >> 24;
+            Response->Buffer[SFLOAT*2*i+1] = (Bits >> 16) & 0xFF;
+            Response->Buffer[SFLOAT*2*i+2] = (Bits >> 8) & 0xFF;
+            Response->Buffer[SFLOAT*2*i+3] = Bits & 0xFF;
+        }
+    }
+} /* End f_Pack */
+
+
+
+int main( int argc, char **argv )
+{
+    char Line[128];
+    unsigned Type;
+    float Angle[3];
+    CLA_ATT_STATE_TYPE State;
+    RESPONSE_TYPE Response;
+    DATA_TYPE Data;
+
+    if( argc != 3 ) { printf( "usage: att_post_ref MountYaw Alpha\n" ); return( 2 ); }
+
+    f_AttPost_Init( strtof( argv[1], NULL ), strtof( argv[2], NULL ) );
+    memset( &State, 0, sizeof(CLA_ATT_STATE_TYPE) );
+
+    while( fgets( Line, sizeof(Line), stdin ) != NULL )
+    {
+        if( strncmp( Line, "restart", 7 ) == 0 )
+        {
+            State.Count = 0;
+            continue;
+        }
+        if( sscanf( Line, "%u %f %f %f", &Type, &Angle[0], &Angle[1], &Angle[2] ) != 4 ) { continue; }
+
+        f_Pack( &Response, Type, Angle );
+        memset( &Data, 0, sizeof(DATA_TYPE) );
+        if( f_AttPost_Run( &State, &Response, &Data ) == FALSE )
+        {
+            printf( "none\n" );
+            continue;
+        }
+        printf( "%.6f %.6f %.6f %.7f %.7f %.7f %.7f\n",
+                Data.Roll, Data.Pitch, Data.Yaw,
+                Data.Quat[0], Data.Quat[1], Data.Quat[2], Data.Quat[3] );
+    }
+
+    return( 0 );
+} /* End main */
@@ -0,0 +1,155 @@
+/*
+ * att_predict_sim.c
+ *
+ *  Host simulator of the latency compensation (Attitude_Predict.c
+ *  built with COMEX_INSTRUMENT INSTR_BENCH), driven by
+ *  tools/att_predict_sim.py.
+ *  The IMU samples a known trajectory every Period_us; each sample
+ *  reaches the predictor Latency_us later (the packet on the wire),
+ *  stamped with its own time plus up to Jitter_us of stamp error and
+ *  Noise_deg of angle noise. A control tick every Control_us asks the
+ *  predictor for the attitude now, in each of HOLD, LINEAR and RATE
+ *  (fed the same samples), and the answer is set against the truth.
+ *  Prints one line per mode,
+ *
+ *      Mode MeanRoll MeanPitch MeanYaw MaxRoll MaxPitch MaxYaw Clamped Restarts
+ *
+ *  then "check", the same from f_AttPredict_Check (ATT_PREDICT_MODE),
+ *  ending in its Samples and Lead_us.
+ *
+ *      att_predict_sim Seconds Period_us Latency_us Jitter_us Noise_deg Control_us YawDps
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "COMEX_Proj.h"
+
+#define SIM_MODES   3
+#define SIM_SEED    0x7F4A7C15UL
+
+static const Uint16 s_Mode[SIM_MODES] = { ATT_PREDICT_HOLD, ATT_PREDICT_LINEAR, ATT_PREDICT_RATE };
+static const char *s_ModeName[SIM_MODES] = { "hold", "linear", "rate" };
+static Uint32 s_Random = SIM_SEED;
+static double s_YawDps;
+
+
+
+/*
+** f_SimRandom
+** xorshift32, uniform in [0,1) */
+static double f_SimRandom( void )
+{
+    s_Random ^= s_Random << 13;
+    s_Random ^= s_Random >> 17;
+    s_Random ^= s_Random << 5;
+    return( s_Random * (1.0/4294967296.0) );
+} /* End f_SimRandom */
+
+
+
+/*
+** f_SimFold
+** Into [-180,180) (deg) */
+static double f_SimFold( double Angle )
+{
+    return( Angle - 360.0*floor( (Angle + 180.0)/360.0 ) );
+} /* End f_SimFold */
+
+
+
+/*
+** f_SimTruth
+** As f_AttPredictTruth, with the yaw rate a parameter */
+static void f_SimTruth( double t, double *Angle )
+{
+    Angle[0] = 30.0*sin( 2.0*M_PI*0.5*t );
+    Angle[1] = 10.0*sin( 2.0*M_PI*0.2*t );
+    Angle[2] = f_SimFold( s_YawDps*t - 170.0 );
+} /* End f_SimTruth */
+
+
+
+int main( int argc, char **argv )
+{
+    Uint16 m, k;
+    Uint32 Queries;
+    Uint64 Period, Latency, Jitter, Control, End, Now, Taken, Stamp;
+    double Noise, Truth[3], Pred_d[3], Err, ErrMean[SIM_MODES][3], ErrMax[SIM_MODES][3];
+    ATT_PREDICT_TYPE P[SIM_MODES];
+    DATA_TYPE Meas, Pred;
+
+    if( argc != 8 )
+    {
+        printf( "usage: att_predict_sim Seconds Period_us Latency_us Jitter_us Noise_deg Control_us YawDps\n" );
+        return( 2 );
+    }
+
+    End     = (Uint64)(strtod( argv[1], NULL )*1.0e6)*IPC_TICKS_PER_US;
+    Period  = strtoull( argv[2], NULL, 0 )*IPC_TICKS_PER_US;
+    Latency = strtoull( argv[3], NULL, 0 )*IPC_TICKS_PER_US;
+    Jitter  = strtoull( argv[4], NULL, 0 )*IPC_TICKS_PER_US;
+    Noise   = strtod( argv[5], NULL );
+    Control = strtoull( argv[6], NULL, 0 )*IPC_TICKS_PER_US;
+    s_YawDps = strtod( argv[7], NULL );
+    if( (Period == 0) || (Control == 0) ) { return( 2 ); }
+
+    for( m=0; m<SIM_MODES; m++ ) { f_AttPredict_Init( &P[m], s_Mode[m] ); }
+    memset( ErrMean, 0, sizeof(ErrMean) );
+    memset( ErrMax, 0, sizeof(ErrMax) );
+    memset( &Meas, 0, sizeof(DATA_TYPE) );
+    Queries = 0;
+    Taken   = 0;
+
+    for( Now=0; Now<End; Now+=Control )
+    {
+        /* Samples which have arrived by this tick */
+        while( Taken + Latency <= Now )
+        {
+            f_SimTruth( (double)Taken/(IPC_TICKS_PER_US*1.0e6), Truth );
+            Meas.Roll  = (float)(Truth[0] + Noise*(2.0*f_SimRandom() - 1.0));
+            Meas.Pitch = (float)(Truth[1] + Noise*(2.0*f_SimRandom() - 1.0));
+            Meas.Yaw   = (float)f_SimFold( Truth[2] + Noise*(2.0*f_SimRandom() - 1.0) );
+            Stamp      = Taken + (Uint64)(Jitter*f_SimRandom());
+
+            for( m=0; m<SIM_MODES; m++ ) { f_AttPredict_Add( &P[m], &Meas, Stamp ); }
+            Taken += Period;
+        }
+
+        /* Every mode from the same start, once LINEAR and RATE can extrapolate */
+        if( P[0].Count < 2 ) { continue; }
+
+        f_SimTruth( (double)Now/(IPC_TICKS_PER_US*1.0e6), Truth );
+        for( m=0; m<SIM_MODES; m++ )
+        {
+            f_AttPredict_Query( &P[m], Now, &Pred );
+            Pred_d[0] = Pred.Roll;
+            Pred_d[1] = Pred.Pitch;
+            Pred_d[2] = Pred.Yaw;
+
+            for( k=0; k<3; k++ )
+            {
+                Err = fabs( f_SimFold( Pred_d[k] - Truth[k] ) );
+                ErrMean[m][k] += Err;
+                if( Err > ErrMax[m][k] ) { ErrMax[m][k] = Err; }
+            }
+        }
+        Queries++;
+    }
+
+    for( m=0; m<SIM_MODES; m++ )
+    {
+        for( k=0; k<3; k++ ) { if( Queries > 0 ) { ErrMean[m][k] /= Queries; } }
+        printf( "%s %.6f %.6f %.6f %.6f %.6f %.6f %u %u\n", s_ModeName[m],
+                ErrMean[m][0], ErrMean[m][1], ErrMean[m][2],
+                ErrMax[m][0], ErrMax[m][1], ErrMax[m][2],
+                P[m].Stats.Clamped, P[m].Stats.Restarts );
+    }
+
+    f_AttPredict_Check( 1000 );
+    printf( "check %.6f %.6f %.6f %.6f %.6f %.6f %u %lu\n",
+            g_AttPredictCheck.ErrMean[0], g_AttPredictCheck.ErrMean[1], g_AttPredictCheck.ErrMean[2],
+            g_AttPredictCheck.ErrMax[0], g_AttPredictCheck.ErrMax[1], g_AttPredictCheck.ErrMax[2],
+            g_AttPredictCheck.Samples, (unsigned long)g_AttPredictCheck.Lead_us );
+
+    return( 0 );
+} /* End main */
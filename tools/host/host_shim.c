@@ -0,0 +1,50 @@
+/*
+ * host_shim.c
+ *
+ *  Device side of a host build (tools/host_build.py): the IPC
+ *  counter off the PC's monotonic clock, the IPC flag register and
+ *  message RAM pointers of F28x_Project.h, and the deadline helpers
+ *  of IO_Helpers.c, which is too tied to the SCI to build here.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "COMEX_Proj.h"
+
+volatile struct IPC_REGS_HOST IpcRegs;
+
+__thread void *g_HostSendRam;
+__thread void *g_HostRecvRam;
+
+
+
+/*
+** ReadIpcTimer
+** 100 ticks per us (IPC_TICKS_PER_US), from CLOCK_MONOTONIC */
+Uint64 ReadIpcTimer( void )
+{
+    struct timespec Ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &Ts );
+    return( (Uint64)Ts.tv_sec*1000000000ULL/10 + (Uint64)Ts.tv_nsec/10 );
+} /* End ReadIpcTimer */
+
+
+
+/*
+** f_Deadline_Set
+** As IO_Helpers.c */
+DEADLINE_TYPE f_Deadline_Set( Uint32 Timeout_us )
+{
+    return( ReadIpcTimer() + (Uint64)Timeout_us*IPC_TICKS_PER_US );
+} /* End f_Deadline_Set */
+
+
+
+/*
+** f_Deadline_Expired
+** As IO_Helpers.c */
+bool f_Deadline_Expired( DEADLINE_TYPE Deadline )
+{
+    return( ReadIpcTimer() >= Deadline );
+} /* End f_Deadline_Expired */
@@ -0,0 +1,233 @@
+/*
+ * ipc_model.c
+ *
+ *  Host model of the CPU2 -> CPU1 sample hand-off, driven by
+ *  tools/ipc_model.py. A producer thread plays CPU2's link loop and
+ *  a consumer thread CPU1's idle loop; both run the real
+ *  Attitude_Snapshot.c and Ipc_Link.c against two message RAMs in
+ *  host memory (host_shim.c gives each thread its own send and
+ *  receive RAM).
+ *  Every sample is filled with a pattern worked out from its Seq,
+ *  so the consumer can tell a torn copy (words of two samples) from
+ *  a good one, in the snapshot and in the mailbox stream. The stream
+ *  may only lose the records the producer counted as MbxFull.
+ *
+ *      ipc_model Samples Period_us Drain_us StallEvery Stall_us
+ *
+ *  Prints name=value lines.
+ */
+
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include "COMEX_Proj.h"
+
+/* The cores see each other's message RAM stores in program order,
+** as x86 (TSO) does; a weaker host would need barriers the target
+** code doesn't have */
+#if !defined(__x86_64__) && !defined(__i386__)
+#error "ipc_model needs x86 store ordering"
+#endif
+
+/* [0] CPU1 -> CPU2, [1] CPU2 -> CPU1 */
+static IPC_MSG_RAM_TYPE s_MsgRam[2];
+
+static Uint32 s_Samples, s_Period_us, s_Drain_us, s_StallEvery, s_Stall_us;
+static volatile Uint16 s_ProducerDone;
+
+/* Consumer's findings */
+static Uint32 s_SnapTorn, s_SnapOrder, s_MbxTorn, s_MbxOrder, s_MbxRecs;
+static Uint16 s_Stuck;
+
+/* Longest the consumer may take to empty the ring once the
+** producer is done */
+#define MODEL_DRAIN_US 1000000UL
+
+
+
+/*
+** f_Pattern
+** Fill Data from Seq, every word different */
+static void f_Pattern( DATA_TYPE *Data, Uint32 Seq )
+{
+    Uint16 *Word = (Uint16 *)Data;
+    Uint16 i;
+
+    for( i=0; i<sizeof(DATA_TYPE)/sizeof(Uint16); i++ )
+    {
+        Word[i] = (Uint16)(Seq*0x9E37UL + i*0x0101U);
+    }
+} /* End f_Pattern */
+
+
+
+/*
+** f_PatternOk
+** TRUE if Rec holds sample Seq and nothing else */
+static bool f_PatternOk( ATT_SAMPLE_TYPE *Rec )
+{
+    DATA_TYPE Want;
+
+    f_Pattern( &Want, Rec->Seq );
+    return( (Rec->ErrorCount == (Uint16)Rec->Seq) && (memcmp( &Want, &Rec->Data, sizeof(DATA_TYPE) ) == 0) );
+} /* End f_PatternOk */
+
+
+
+/*
+** f_ProducerWait
+** Spend Wait_us as the link loop does between samples, polling
+** the mailbox every pass. Passes yield, so both sides still make
+** progress on a single core host */
+static void f_ProducerWait( Uint32 Wait_us )
+{
+    Uint64 End = ReadIpcTimer() + (Uint64)Wait_us*IPC_TICKS_PER_US;
+
+    do { f_IpcMbx_Poll( FALSE ); sched_yield(); } while( ReadIpcTimer() < End );
+} /* End f_ProducerWait */
+
+
+
+/*
+** f_Producer
+** CPU2: publish s_Samples samples every s_Period_us, and every
+** s_StallEvery samples go quiet for s_Stall_us and time out the
+** way f_LinkLoop does */
+static void *f_Producer( void *Arg )
+{
+    Uint32 Seq;
+    DATA_TYPE Data;
+
+    g_HostSendRam = &s_MsgRam[1];
+    g_HostRecvRam = &s_MsgRam[0];
+
+    for( Seq=1; Seq<=s_Samples; Seq++ )
+    {
+        f_Pattern( &Data, Seq );
+        f_IpcLink_Publish( &Data, (Uint16)Seq );
+
+        if( s_StallEvery && ((Seq % s_StallEvery) == 0) )
+        {
+            f_ProducerWait( s_Stall_us );
+            f_IpcMbx_Poll( TRUE );
+        }
+        else
+        {
+            f_ProducerWait( s_Period_us );
+        }
+    }
+    f_IpcMbx_Flush();
+    s_ProducerDone = TRUE;
+
+    return( NULL );
+} /* End f_Producer */
+
+
+
+/*
+** f_Consumer
+** CPU1: the idle loop of the CPU2 link build, snapshot and
+** mailbox, every s_Drain_us until the producer is done and the
+** ring is empty, or s_Stuck if it never empties */
+static void *f_Consumer( void *Arg )
+{
+    ATT_SAMPLE_TYPE Sample, Stream[IPC_MBX_BATCH];
+    Uint16 nStream, i;
+    Uint32 LastSnap = 0, LastRec = 0;
+    Uint16 Done;
+    Uint64 DoneAt = 0;
+
+    g_HostSendRam = &s_MsgRam[0];
+    g_HostRecvRam = &s_MsgRam[1];
+
+    for( ;; )
+    {
+        /* Before the drain, so a final batch is never left behind */
+        Done = s_ProducerDone;
+
+        if( f_IpcLink_Receive( &Sample ) )
+        {
+            if( f_PatternOk( &Sample ) == FALSE ) { s_SnapTorn++; }
+            if( Sample.Seq <= LastSnap ) { s_SnapOrder++; }
+            LastSnap = Sample.Seq;
+        }
+
+        nStream = f_IpcMbx_Get( Stream, IPC_MBX_BATCH );
+        for( i=0; i<nStream; i++ )
+        {
+            if( f_PatternOk( &Stream[i] ) == FALSE ) { s_MbxTorn++; }
+            if( Stream[i].Seq <= LastRec ) { s_MbxOrder++; }
+            LastRec = Stream[i].Seq;
+        }
+        f_IpcMbx_Log( Stream, nStream );
+        s_MbxRecs += nStream;
+
+        if( Done && (nStream == 0) && (IPC_RECV_RAM->MbxHead == IPC_SEND_RAM->MbxTail) ) { break; }
+        if( Done && (DoneAt == 0) ) { DoneAt = ReadIpcTimer(); }
+        if( DoneAt && (ReadIpcTimer() - DoneAt > (Uint64)MODEL_DRAIN_US*IPC_TICKS_PER_US) )
+        {
+            s_Stuck = TRUE;
+            break;
+        }
+
+        if( s_Drain_us == 0 ) { sched_yield(); }
+        else
+        {
+            Uint64 End = ReadIpcTimer() + (Uint64)s_Drain_us*IPC_TICKS_PER_US;
+            while( ReadIpcTimer() < End ) { sched_yield(); }
+        }
+    }
+
+    return( NULL );
+} /* End f_Consumer */
+
+
+
+int main( int argc, char **argv )
+{
+    pthread_t Producer, Consumer;
+    Uint16 Unexplained;
+
+    if( argc != 6 ) { printf( "usage: ipc_model Samples Period_us Drain_us StallEvery Stall_us\n" ); return( 2 ); }
+    s_Samples    = strtoul( argv[1], NULL, 0 );
+    s_Period_us  = strtoul( argv[2], NULL, 0 );
+    s_Drain_us   = strtoul( argv[3], NULL, 0 );
+    s_StallEvery = strtoul( argv[4], NULL, 0 );
+    s_Stall_us   = strtoul( argv[5], NULL, 0 );
+
+    /* Each CPU clears its own send RAM */
+    g_HostSendRam = &s_MsgRam[0];
+    f_IpcLink_Init();
+    g_HostSendRam = &s_MsgRam[1];
+    f_IpcLink_Init();
+
+    pthread_create( &Consumer, NULL, f_Consumer, NULL );
+    pthread_create( &Producer, NULL, f_Producer, NULL );
+    pthread_join( Producer, NULL );
+    pthread_join( Consumer, NULL );
+
+    /* Records the stream lost beyond the refused ones (MbxFull
+    ** is 16 bit, so is the difference) */
+    Unexplained = (Uint16)(s_Samples - s_MbxRecs - g_IpcLinkStats.MbxFull);
+
+    printf( "published=%lu\n",     (unsigned long)g_IpcLinkStats.Published );
+    printf( "snap_received=%lu\n", (unsigned long)g_IpcLinkStats.Received );
+    printf( "snap_missed=%lu\n",   (unsigned long)g_IpcLinkStats.Missed );
+    printf( "snap_retries=%u\n",   g_IpcLinkStats.Retries );
+    printf( "snap_failed=%u\n",    g_IpcLinkStats.Failed );
+    printf( "snap_torn=%lu\n",     (unsigned long)s_SnapTorn );
+    printf( "snap_order=%lu\n",    (unsigned long)s_SnapOrder );
+    printf( "mbx_put=%lu\n",       (unsigned long)g_IpcLinkStats.MbxPut );
+    printf( "mbx_got=%lu\n",       (unsigned long)g_IpcLinkStats.MbxGot );
+    printf( "mbx_full=%u\n",       g_IpcLinkStats.MbxFull );
+    printf( "mbx_batches=%u\n",    g_IpcLinkStats.MbxBatches );
+    printf( "mbx_timed=%u\n",      g_IpcLinkStats.MbxTimed );
+    printf( "mbx_torn=%lu\n",      (unsigned long)s_MbxTorn );
+    printf( "mbx_order=%lu\n",     (unsigned long)s_MbxOrder );
+    printf( "log_gaps=%u\n",       g_IpcLinkStats.LogGaps );
+    printf( "log_age_max_us=%lu\n", (unsigned long)g_IpcLinkStats.LogAgeMax_us );
+    printf( "unexplained=%u\n",    Unexplained );
+    printf( "stuck=%u\n",          s_Stuck );
+
+    return( 0 );
+} /* End main */
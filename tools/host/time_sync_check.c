@@ -0,0 +1,30 @@
+/*
+ * time_sync_check.c
+ *
+ *  Host run of f_TimeSync_Check (Time_Sync.c built with
+ *  COMEX_INSTRUMENT INSTR_BENCH), driven by tools/time_sync_sim.py,
+ *  which sets the skew, jitter and window. Prints g_TimeSyncCheck:
+ *
+ *      SkewPpm SkewErrPpm MaxErr_us ResidRms_us Restarts
+ *
+ *      time_sync_check Pairs
+ */
+
+#include <stdlib.h>
+#include "COMEX_Proj.h"
+
+
+
+int main( int argc, char **argv )
+{
+    if( argc != 2 ) { printf( "usage: time_sync_check Pairs\n" ); return( 2 ); }
+
+    f_TimeSync_Check( (Uint16)strtoul( argv[1], NULL, 0 ) );
+
+    printf( "%.3f %.6f %.6f %.6f %u\n",
+            g_TimeSyncCheck.SkewPpm, g_TimeSyncCheck.SkewErrPpm,
+            g_TimeSyncCheck.MaxErr_us, g_TimeSyncCheck.ResidRms_us,
+            g_TimeSyncCheck.Restarts );
+
+    return( 0 );
+} /* End main */
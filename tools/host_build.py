@@ -0,0 +1,66 @@
+#!/usr/bin/env python
+#
+# host_build.py
+#
+#  Builds repo sources with the PC's C compiler, for the tools which
+#  run the real code instead of a copy of it (ipc_model.py,
+#  arq_sim.py, ...). tools/host holds the stand-in F28x_Project.h,
+#  host_shim.c and a small C driver per tool. Settings go in through
+#  a generated COMEX_CONFIG_LOCAL header, so the sources see them as
+#  they would an edit of COMEX_Config.h:
+#
+#      import host_build
+#      exe = host_build.build('arq_check', ['Link_Arq.c'], {'ARQ_WINDOW': 8})
+#      print(host_build.run(exe, ['10000']))
+#
+#  The compiler is $CC, gcc if unset. Nothing is left behind in the
+#  tree, the build goes to a temporary directory.
+#
+
+import os
+import sys
+import atexit
+import shutil
+import tempfile
+import subprocess
+
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+HOST = os.path.join(TOOLS, 'host')
+
+
+def build(driver, sources, config=None, preset=0, flags=(), libs=()):
+    """Compile tools/host/<driver>.c, host_shim.c and the repo sources,
+    with config {name: value} overriding COMEX_Config.h.
+    Returns the path of the executable, exits on a compile error"""
+    tmp = tempfile.mkdtemp(prefix='comex_host_')
+    atexit.register(shutil.rmtree, tmp, True)
+
+    local = os.path.join(tmp, 'host_config.h')
+    with open(local, 'w') as f:
+        for name, value in sorted((config or {}).items()):
+            f.write('#undef %s\n#define %s %s\n' % (name, name, value))
+
+    exe = os.path.join(tmp, driver)
+    cmd = [os.environ.get('CC', 'gcc'), '-std=gnu99', '-O2', '-Wall', '-Wno-unknown-pragmas',
+           '-DCPU1', '-DCOMEX_CONFIG=%d' % preset, '-DCOMEX_CONFIG_LOCAL="%s"' % local,
+           '-I' + HOST, '-I' + ROOT]
+    cmd += list(flags)
+    cmd += [os.path.join(HOST, driver + '.c'), os.path.join(HOST, 'host_shim.c')]
+    cmd += [os.path.join(ROOT, s) for s in sources]
+    cmd += ['-o', exe, '-lm'] + list(libs)
+
+    if subprocess.call(cmd) != 0:
+        sys.exit('host build of %s failed' % driver)
+    return exe
+
+
+def run(exe, args=(), lines=None):
+    """Run a built driver, with lines on its stdin if given,
+    its stdout split into lines"""
+    p = subprocess.Popen([exe] + [str(a) for a in args], stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+    out, _ = p.communicate(''.join(l + '\n' for l in (lines or ())).encode())
+    if p.returncode != 0:
+        sys.exit('%s exited with %d' % (os.path.basename(exe), p.returncode))
+    return out.decode().splitlines()
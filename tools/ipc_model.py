@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+#
+# ipc_model.py
+#
+#  Two thread host model of the CPU2 -> CPU1 sample hand-off
+#  (COMEX_IMU_ON_CPU2): builds the real Attitude_Snapshot.c and
+#  Ipc_Link.c with tools/host/ipc_model.c (host_build.py) and runs a
+#  producer thread (CPU2's link loop) against a consumer thread
+#  (CPU1's idle loop) over message RAMs in host memory:
+#
+#      python tools/ipc_model.py
+#      python tools/ipc_model.py --period-us 0 --drain-us 0 --samples 1000000
+#      python tools/ipc_model.py --batch 8 --flush-us 5000 --drain-us 2000
+#
+#  Fails (exit 1) on a torn snapshot or mailbox record, a sample out
+#  of order, a stream gap the producer did not count as MbxFull, or
+#  a ring the consumer can't empty.
+#  Torn copies need the threads to overlap, so run it on a host with
+#  at least two cores; on one core they only meet at preemption.
+#
+
+import sys
+import argparse
+
+import host_build
+
+
+CHECKS = ('snap_torn', 'snap_order', 'mbx_torn', 'mbx_order', 'unexplained', 'stuck')
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Host model of the snapshot and mailbox hand-off')
+    ap.add_argument('--samples', type=int, default=20000, help='samples the producer publishes')
+    ap.add_argument('--period-us', type=int, default=100, help='producer sample period, 0 flat out')
+    ap.add_argument('--drain-us', type=int, default=50, help='consumer loop period, 0 flat out')
+    ap.add_argument('--stall-every', type=int, default=1001, help='samples between link stalls, 0 none')
+    ap.add_argument('--stall-us', type=int, default=30000, help='stall length (a link timeout at its end)')
+    ap.add_argument('--batch', type=int, default=4, help='IPC_MBX_BATCH')
+    ap.add_argument('--depth', type=int, default=16, help='IPC_MBX_DEPTH, a power of 2')
+    ap.add_argument('--flush-us', type=int, default=20000, help='IPC_MBX_FLUSH_US')
+    args = ap.parse_args()
+
+    if args.depth & (args.depth - 1):
+        ap.error('--depth must be a power of 2')
+
+    config = {
+        'COMEX_IMU_ON_CPU2': 1,
+        'IPC_MBX_BATCH': args.batch,
+        'IPC_MBX_DEPTH': args.depth,
+        'IPC_MBX_FLUSH_US': '%dUL' % args.flush_us,
+    }
+    exe = host_build.build('ipc_model', ['Ipc_Link.c', 'Attitude_Snapshot.c'], config, libs=['-pthread'])
+
+    result = {}
+    for line in host_build.run(exe, [args.samples, args.period_us, args.drain_us,
+                                     args.stall_every, args.stall_us]):
+        name, value = line.split('=')
+        result[name] = int(value)
+        print('%-16s %d' % (name, result[name]))
+
+    failed = [c for c in CHECKS if result[c] != 0]
+    if failed:
+        print('FAILED: ' + ', '.join(failed))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,131 @@
+#!/usr/bin/env python
+#
+# map_report.py
+#
+#  RAM headroom report for a TI C2000 linker map file.
+#  Run as a post-build step (see .cproject) or by hand:
+#
+#      python tools/map_report.py CPU1_RAM/COMEX_C2000_V3.map
+#
+#  Prints used/free words for every RAM block and the output
+#  sections placed in the LS blocks the project owns.
+#  Exits with 1 if a section other than the ones COMEX_Sections.cmd
+#  assigns to a block has landed there (e.g. .text spilling into a
+#  CLA block), or if a block has less than --min-free words left.
+#
+
+import re
+import sys
+import argparse
+
+
+# Block -> output sections allowed in it (COMEX_Sections.cmd)
+OWNED = {
+    'RAMLS1': ['ComexRxRing', 'ComexPool', 'ComexHistory', 'ComexTrace', 'ComexRetain'],
+    'RAMLS2': ['ComexHotCode'],
+    'RAMLS3': ['.scratchpad', '.bss_cla', '.const_cla'],
+    'RAMLS4': ['Cla1Prog'],
+}
+
+RAM_BLOCK = re.compile(r'^(RAM\w+|CLA1_MSGRAM\w+|CPU\dTOCPU\dRAM)$')
+
+
+def parse_memory(lines):
+    """ MEMORY CONFIGURATION -> {name: (origin, length, used)} """
+    blocks = {}
+    inside = False
+    for line in lines:
+        if line.startswith('MEMORY CONFIGURATION'):
+            inside = True
+            continue
+        if inside and line.startswith('SECTION ALLOCATION MAP'):
+            break
+        if not inside:
+            continue
+        f = line.split()
+        if len(f) >= 5 and RAM_BLOCK.match(f[0]):
+            try:
+                blocks[f[0]] = (int(f[1], 16), int(f[2], 16), int(f[3], 16))
+            except ValueError:
+                pass
+    return blocks
+
+
+def parse_sections(lines):
+    """ SECTION ALLOCATION MAP -> [(name, run origin, length)] """
+    sections = []
+    inside = False
+    name = None
+    head = re.compile(r'^(\S+)\s+(\d)\s+([0-9a-fA-F]{8})\s+([0-9a-fA-F]{8})(.*)$')
+    cont = re.compile(r'^\*\s+(\d)\s+([0-9a-fA-F]{8})\s+([0-9a-fA-F]{8})(.*)$')
+    run  = re.compile(r'RUN ADDR\s*=\s*([0-9a-fA-F]{8})')
+
+    for line in lines:
+        if line.startswith('SECTION ALLOCATION MAP'):
+            inside = True
+            continue
+        if inside and line.startswith('GLOBAL SYMBOLS'):
+            break
+        if not inside or not line.strip() or line.startswith(' '):
+            continue
+
+        m = head.match(line)
+        if m:
+            name, origin, length, rest = m.group(1), m.group(3), m.group(4), m.group(5)
+        else:
+            m = cont.match(line)
+            if m and name:
+                origin, length, rest = m.group(2), m.group(3), m.group(4)
+            else:
+                name = line.split()[0]
+                continue
+
+        r = run.search(rest)
+        if r:
+            origin = r.group(1)
+        if 'DSECT' not in rest:
+            sections.append((re.sub(r'\.\d+$', '', name), int(origin, 16), int(length, 16)))
+        name = None
+    return sections
+
+
+def main():
+    ap = argparse.ArgumentParser(description='RAM headroom per block from a TI map file')
+    ap.add_argument('map')
+    ap.add_argument('--min-free', type=int, default=0,
+                    help='fail if an owned block has fewer free words')
+    args = ap.parse_args()
+
+    with open(args.map) as f:
+        lines = f.read().splitlines()
+
+    blocks = parse_memory(lines)
+    sections = parse_sections(lines)
+    failed = False
+
+    print('%-16s %8s %8s %8s %6s' % ('block', 'length', 'used', 'free', 'used%'))
+    for name in sorted(blocks, key=lambda b: blocks[b][0]):
+        origin, length, used = blocks[name]
+        print('%-16s %8d %8d %8d %5.0f%%' % (name, length, used, length - used,
+                                            100.0 * used / length if length else 0))
+
+    print('')
+    for block in sorted(OWNED):
+        if block not in blocks:
+            continue
+        origin, length, used = blocks[block]
+        print('%s (%d words free)' % (block, length - used))
+        for sname, sorg, slen in sections:
+            if origin <= sorg < origin + length and slen > 0:
+                ok = sname in OWNED[block]
+                print('   %-20s %06x %6d%s' % (sname, sorg, slen, '' if ok else '   <-- not assigned here'))
+                failed = failed or not ok
+        if length - used < args.min_free:
+            print('   less than %d words free' % args.min_free)
+            failed = True
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,107 @@
+#!/usr/bin/env python
+#
+# size_report.py
+#
+#  Code/const/data size per object file, from the linkInfo.xml the
+#  TI linker writes next to the .out (--xml_link_info, on in every
+#  build configuration). Give it more than one build to compare
+#  configurations (COMEX_Config.h), e.g. a FULL and a LEAN build:
+#
+#      python tools/size_report.py CPU1_RAM/COMEX_C2000_V3_linkInfo.xml \
+#                                  CPU1_LEAN/COMEX_C2000_V3_linkInfo.xml
+#
+#  Sizes are in 16 bit words. Columns after the first build show
+#  the change against the first one.
+#
+
+import os
+import sys
+import argparse
+import xml.etree.ElementTree as ET
+
+
+CODE  = ('.text', 'ComexHotCode', 'Cla1Prog', 'codestart', '.TI.ramfunc', 'ramfuncs')
+CONST = ('.econst', '.const', '.const_cla', '.switch', '.cinit', '.pinit', '.init_array')
+SKIP  = ('.debug', '.reset', '.vectors')
+
+KINDS = ('code', 'const', 'data')
+
+
+def kind(section):
+    """ Output class of an input section, or None if it isn't counted """
+    if section.startswith(SKIP) or section.endswith('RegsFile') or section.endswith('File'):
+        return None
+    if section.startswith(CODE):
+        return 'code'
+    if section.startswith(CONST):
+        return 'const'
+    return 'data'
+
+
+def load(path):
+    """ linkInfo.xml -> {object file: {kind: words}} """
+    root = ET.parse(path).getroot()
+
+    files = {}
+    for f in root.iter('input_file'):
+        name = f.findtext('name') or f.findtext('file')
+        if f.findtext('kind') == 'archive':
+            name = '%s(%s)' % (f.findtext('file'), name)
+        files[f.get('id')] = name
+
+    sizes = {}
+    for oc in root.iter('object_component'):
+        k = kind(oc.findtext('name') or '')
+        ref = oc.find('input_file_ref')
+        if k is None or ref is None:
+            continue
+        obj = files.get(ref.get('idref'), '?')
+        if '.lib(' in obj:
+            obj = 'runtime library'
+        words = int(oc.findtext('size') or '0', 16)
+        sizes.setdefault(obj, dict.fromkeys(KINDS, 0))[k] += words
+    return sizes
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Size per object file from TI linkInfo.xml')
+    ap.add_argument('xml', nargs='+')
+    ap.add_argument('--label', action='append',
+                    help='name for each build, in order (default: its directory)')
+    args = ap.parse_args()
+
+    labels = args.label or []
+    labels += [os.path.basename(os.path.dirname(os.path.abspath(p))) for p in args.xml[len(labels):]]
+    builds = [load(p) for p in args.xml]
+    objs = sorted(set(o for b in builds for o in b))
+
+    head = '%-32s' % 'object'
+    for i, label in enumerate(labels):
+        head += ' | %-22s' % (label if i == 0 else label + ' (delta)')
+    print(head)
+    print('%-32s' % '' + ' | %6s %6s %8s' % ('code', 'const', 'data') * len(builds))
+
+    totals = [dict.fromkeys(KINDS, 0) for b in builds]
+    for o in objs + ['total']:
+        row = '%-32s' % o
+        for i, b in enumerate(builds):
+            if o == 'total':
+                s = totals[i]
+            else:
+                s = b.get(o, dict.fromkeys(KINDS, 0))
+                for k in KINDS:
+                    totals[i][k] += s[k]
+            if i == 0:
+                row += ' | %6d %6d %8d' % tuple(s[k] for k in KINDS)
+            else:
+                base = totals[0] if o == 'total' else builds[0].get(o, dict.fromkeys(KINDS, 0))
+                row += ' | %+6d %+6d %+8d' % tuple(s[k] - base[k] for k in KINDS)
+        if o == 'total':
+            print('-' * len(row))
+        print(row)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
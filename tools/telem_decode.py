@@ -0,0 +1,164 @@
+#!/usr/bin/env python
+#
+# telem_decode.py
+#
+#  Host side of the telemetry stream (Telemetry.c). Reads frames
+#  from a serial port (needs pyserial) or from a capture file and
+#  prints one line per record, CSV with --csv:
+#
+#      python tools/telem_decode.py --port COM5 --baud 115200
+#      python tools/telem_decode.py capture.bin --csv > run.csv
+#
+#  The frame layout is described in COMEX_Proj.h (TELEM_*) and must
+#  agree with it. Frames with a bad checksum are skipped and the
+#  decoder resynchronises on the next sync pair; gaps in Seq are
+#  frames the target dropped (TX ring full) or the line lost.
+#  Totals go to stderr at the end.
+#
+
+import sys
+import struct
+import argparse
+
+
+SYNC = b'\xa5\x5a'
+HEAD = 7          # Sync, Length, Seq, Channels, nRecords
+MAX_LENGTH = 4096
+
+CH_STAMPS  = 0x01
+CH_RPY     = 0x02
+CH_HEALTH  = 0x04
+CH_PROFILE = 0x08
+
+SYSCLK_HZ = 100e6   # IPC counter rate (COMEX_SYSCLK_MHZ)
+
+HEALTH = ('primary', 'good', 'timeouts', 'bad_checksum', 'rx_overruns',
+          'fifo_overflows', 'pool_empty', 'missed_ticks', 'telem_dropped')
+
+
+def records(channels, n, body):
+    """ Record bytes of one frame -> list of dicts """
+    out = []
+    i = 0
+    for _ in range(n):
+        r = {}
+        if channels & CH_STAMPS:
+            r['stamp'], r['sample_stamp'] = struct.unpack_from('>II', body, i)
+            i += 8
+        if channels & CH_RPY:
+            r['roll'], r['pitch'], r['yaw'] = struct.unpack_from('>fff', body, i)
+            i += 12
+        if channels & CH_HEALTH:
+            v = struct.unpack_from('>B8H', body, i)
+            r.update(zip(HEALTH, v))
+            i += 17
+        if channels & CH_PROFILE:
+            nt = body[i]
+            i += 1
+            for t in range(nt):
+                last, worst, over = struct.unpack_from('>IIH', body, i)
+                r['task%d_last' % t] = last
+                r['task%d_max' % t] = worst
+                r['task%d_overruns' % t] = over
+                i += 10
+        out.append(r)
+    if i != len(body):
+        raise ValueError('record size mismatch (%d of %d bytes)' % (i, len(body)))
+    return out
+
+
+class Decoder(object):
+    def __init__(self):
+        self.buf = bytearray()
+        self.frames = 0
+        self.bad = 0
+        self.lost = 0
+        self.seq = None
+
+    def feed(self, data):
+        """ Bytes in, decoded records out """
+        self.buf += data
+        out = []
+        while True:
+            k = self.buf.find(SYNC)
+            if k < 0:
+                del self.buf[:-1]
+                return out
+            del self.buf[:k]
+            if len(self.buf) < HEAD:
+                return out
+            length = (self.buf[2] << 8) | self.buf[3]
+            if length < 3 or length > MAX_LENGTH:
+                self.bad += 1
+                del self.buf[:1]
+                continue
+            if len(self.buf) < 4 + length + 1:
+                return out
+            frame = bytes(self.buf[4:4 + length])
+            if (sum(frame) & 0xFF) != self.buf[4 + length]:
+                self.bad += 1
+                del self.buf[:1]
+                continue
+            del self.buf[:4 + length + 1]
+
+            seq, channels, n = frame[0], frame[1], frame[2]
+            try:
+                recs = records(channels, n, frame[3:])
+            except (ValueError, struct.error):
+                self.bad += 1
+                continue
+            if self.seq is not None:
+                self.lost += (seq - self.seq - 1) & 0xFF
+            self.seq = seq
+            self.frames += 1
+            for r in recs:
+                r['seq'] = seq
+            out += recs
+
+
+def source(args):
+    if args.port:
+        import serial
+        s = serial.Serial(args.port, args.baud, timeout=0.1)
+        while True:
+            yield s.read(4096)
+    else:
+        f = sys.stdin.buffer if args.file == '-' else open(args.file, 'rb')
+        while True:
+            data = f.read(4096)
+            if not data:
+                return
+            yield data
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Decode the COMEX telemetry stream')
+    ap.add_argument('file', nargs='?', default='-', help='capture file (default stdin)')
+    ap.add_argument('--port', help='serial port to read instead of a file')
+    ap.add_argument('--baud', type=int, default=115200, help='TELEM_BAUD')
+    ap.add_argument('--csv', action='store_true', help='CSV instead of key=value lines')
+    args = ap.parse_args()
+
+    dec = Decoder()
+    cols = None
+    try:
+        for data in source(args):
+            for r in dec.feed(data):
+                if 'stamp' in r:
+                    r['t_s'] = '%.6f' % (r['stamp'] / SYSCLK_HZ)
+                if args.csv:
+                    if cols is None:
+                        cols = sorted(r)
+                        print(','.join(cols))
+                    print(','.join(str(r.get(c, '')) for c in cols))
+                else:
+                    print(' '.join('%s=%s' % (k, r[k]) for k in sorted(r)))
+    except KeyboardInterrupt:
+        pass
+
+    sys.stderr.write('%d frames, %d bad, %d lost\n' % (dec.frames, dec.bad, dec.lost))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
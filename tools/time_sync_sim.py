@@ -0,0 +1,71 @@
+#!/usr/bin/env python
+#
+# time_sync_sim.py
+#
+#  Error of the IMU clock fit for other skews, jitter and window
+#  sizes than the target's: builds the real Time_Sync.c with
+#  tools/host/time_sync_check.c (host_build.py) and runs
+#  f_TimeSync_Check on its synthetic link (100 Hz, skew, 1 ms delay
+#  plus jitter, an IMU stamp wrap), so each row is what
+#  f_TimeSync_Check leaves in g_TimeSyncCheck on target with the
+#  same settings. One build per skew:
+#
+#      python tools/time_sync_sim.py
+#      python tools/time_sync_sim.py --ppm 20 50 100 --jitter-us 1000 --depth 8
+#
+
+import sys
+import argparse
+
+import host_build
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Error of the IMU clock fit on a synthetic link')
+    ap.add_argument('--pairs', type=int, default=2000, help='samples at 100 Hz (f_TimeSync_Check)')
+    ap.add_argument('--ppm', type=int, nargs='+', default=[100], help='skew, ppm (TIME_SYNC_CHECK_PPM)')
+    ap.add_argument('--jitter-us', type=int, default=200, help='arrival jitter (TIME_SYNC_CHECK_JITTER_US)')
+    ap.add_argument('--depth', type=int, default=16, help='TIME_SYNC_DEPTH, a power of 2 (FULL: 16)')
+    ap.add_argument('--spacing-us', type=int, default=500000, help='TIME_SYNC_SPACING_US')
+    ap.add_argument('--min-pairs', type=int, default=4, help='TIME_SYNC_MIN_PAIRS')
+    ap.add_argument('--outlier-us', type=float, default=2000.0, help='TIME_SYNC_OUTLIER_US')
+    ap.add_argument('--max-rejects', type=int, default=4, help='TIME_SYNC_MAX_REJECTS')
+    ap.add_argument('--csv', action='store_true', help='CSV instead of a table')
+    args = ap.parse_args()
+
+    if args.depth < 1 or args.depth & (args.depth - 1):
+        ap.error('--depth must be a power of 2')
+    if not 0 < args.pairs <= 0xFFFF:
+        ap.error('--pairs is a Uint16')
+    if any(ppm < 0 for ppm in args.ppm) or args.jitter_us < 0:
+        ap.error('--ppm and --jitter-us are unsigned on target')
+
+    if args.csv:
+        print('ppm,skew_err_ppm,max_err_us,resid_rms_us,restarts')
+    else:
+        print('%6s %12s %10s %12s %8s' % ('ppm', 'skew err ppm', 'max us', 'resid rms us', 'restarts'))
+    for ppm in args.ppm:
+        config = {
+            'COMEX_USE_TIME_SYNC': 1,
+            'COMEX_INSTRUMENT': 'INSTR_BENCH',
+            'TIME_SYNC_CHECK_PPM': '%dUL' % ppm,
+            'TIME_SYNC_CHECK_JITTER_US': '%dUL' % args.jitter_us,
+            'TIME_SYNC_DEPTH': args.depth,
+            'TIME_SYNC_SPACING_US': '%dUL' % args.spacing_us,
+            'TIME_SYNC_MIN_PAIRS': args.min_pairs,
+            'TIME_SYNC_OUTLIER_US': '%rf' % args.outlier_us,
+            'TIME_SYNC_MAX_REJECTS': args.max_rejects,
+        }
+        exe = host_build.build('time_sync_check', ['Time_Sync.c'], config)
+
+        v = host_build.run(exe, [args.pairs])[0].split()
+        skew_err, max_err, rms, restarts = float(v[1]), float(v[2]), float(v[3]), int(v[4])
+        if args.csv:
+            print('%d,%.3f,%.1f,%.1f,%d' % (ppm, skew_err, max_err, rms, restarts))
+        else:
+            print('%6d %12.3f %10.1f %12.1f %8d' % (ppm, skew_err, max_err, rms, restarts))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())